@@ -0,0 +1,78 @@
+// Подсчёт выделений динамической памяти для цели transport_catalogue_alloc_bench.
+// Глобальные operator new и operator delete заменяются счётчиками; перед выходом из программы
+// в stderr выводятся число выделений, их суммарный объём и пиковый объём занятой памяти.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// Перед каждым блоком хранится его размер, чтобы при освобождении уменьшить занятый объём
+constexpr size_t HEADER_SIZE = alignof(std::max_align_t);
+
+std::atomic<size_t> allocation_count{ 0 };
+std::atomic<size_t> allocated_bytes{ 0 };
+std::atomic<size_t> live_bytes{ 0 };
+std::atomic<size_t> peak_live_bytes{ 0 };
+
+void* Allocate(size_t size) {
+    void* block = std::malloc(size + HEADER_SIZE);
+    if (block == nullptr) {
+        throw std::bad_alloc();
+    }
+    *static_cast<size_t*>(block) = size;
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    const size_t live = live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+    size_t peak = peak_live_bytes.load(std::memory_order_relaxed);
+    while (live > peak && !peak_live_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+    return static_cast<char*>(block) + HEADER_SIZE;
+}
+
+void Deallocate(void* ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+    void* block = static_cast<char*>(ptr) - HEADER_SIZE;
+    live_bytes.fetch_sub(*static_cast<size_t*>(block), std::memory_order_relaxed);
+    std::free(block);
+}
+
+struct AllocationReport {
+    ~AllocationReport() {
+        std::fprintf(stderr, "Allocations: %zu, allocated bytes: %zu, peak live bytes: %zu\n",
+            allocation_count.load(), allocated_bytes.load(), peak_live_bytes.load());
+    }
+};
+
+const AllocationReport allocation_report;
+
+} // namespace
+
+void* operator new(size_t size) {
+    return Allocate(size);
+}
+
+void* operator new[](size_t size) {
+    return Allocate(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    Deallocate(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    Deallocate(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    Deallocate(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    Deallocate(ptr);
+}
@@ -0,0 +1,534 @@
+#pragma once
+
+#include "router.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Маршрутизатор на основе иерархии сжатия (Contraction Hierarchies).
+// При построении вершины по очереди "сжимаются": кратчайшие пути через сжимаемую вершину
+// заменяются ярлыками между её соседями. Запрос - двунаправленный поиск Дейкстры,
+// идущий только вверх по рангам; найденные ярлыки раскрываются в рёбра исходного графа.
+template <typename Weight>
+class ContractionHierarchy {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using RouteInfo = typename Router<Weight>::RouteInfo;
+
+    static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+
+    // Ребро иерархии: либо ребро исходного графа (original_edge),
+    // либо ярлык из двух последовательных рёбер иерархии first и second
+    struct HierarchyEdge {
+        VertexId from;
+        VertexId to;
+        Weight weight;
+        EdgeId original_edge;
+        size_t first;
+        size_t second;
+    };
+
+    // Ранг вершины - её номер в порядке сжатия
+    struct HierarchyData {
+        std::vector<size_t> ranks;
+        std::vector<HierarchyEdge> edges;
+    };
+
+    explicit ContractionHierarchy(const Graph& graph);
+    // Принимает готовую иерархию, не перестраивая её
+    ContractionHierarchy(const Graph& graph, HierarchyData hierarchy_data);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+    // Матрица весов методом корзин: обратный поиск вверх от каждой вершины из targets
+    // раскладывает расстояния по корзинам вершин, прямой поиск вверх от каждой вершины
+    // из sources собирает их. Каждый поиск выполняется один раз, а не на каждую пару
+    std::vector<std::vector<std::optional<Weight>>> BuildWeightMatrix(const std::vector<VertexId>& sources,
+        const std::vector<VertexId>& targets) const;
+    const HierarchyData& GetHierarchyData() const;
+
+private:
+    using QueueItem = std::pair<Weight, VertexId>;
+
+    // Состояние одного поиска Дейкстры с переиспользуемыми буферами
+    struct SearchSpace {
+        std::vector<Weight> distances;
+        std::vector<size_t> parent_edges;
+        std::vector<bool> reached;
+        std::vector<bool> settled;
+        std::vector<VertexId> touched_vertices;
+        std::vector<QueueItem> queue;
+
+        void Resize(size_t vertex_count) {
+            distances.resize(vertex_count);
+            parent_edges.resize(vertex_count);
+            reached.resize(vertex_count);
+            settled.resize(vertex_count);
+        }
+
+        void Reset() {
+            for (const VertexId vertex : touched_vertices) {
+                reached[vertex] = false;
+                settled[vertex] = false;
+            }
+            touched_vertices.clear();
+            queue.clear();
+        }
+
+        void Push(VertexId vertex, Weight weight, size_t parent_edge) {
+            if (!reached[vertex]) {
+                reached[vertex] = true;
+                touched_vertices.push_back(vertex);
+            }
+            distances[vertex] = weight;
+            parent_edges[vertex] = parent_edge;
+            queue.emplace_back(weight, vertex);
+            std::push_heap(queue.begin(), queue.end(), std::greater<QueueItem>{});
+        }
+
+        // Извлекает ближайшую неосвоенную вершину, пропуская устаревшие элементы очереди
+        std::optional<QueueItem> Pop() {
+            while (!queue.empty()) {
+                std::pop_heap(queue.begin(), queue.end(), std::greater<QueueItem>{});
+                const QueueItem item = queue.back();
+                queue.pop_back();
+                if (!settled[item.second]) {
+                    settled[item.second] = true;
+                    return item;
+                }
+            }
+            return std::nullopt;
+        }
+
+        bool Improves(VertexId vertex, Weight weight) const {
+            return !reached[vertex] || (!settled[vertex] && weight < distances[vertex]);
+        }
+    };
+
+    // Граф, который меняется во время сжатия
+    struct ContractionState {
+        std::vector<std::vector<size_t>> out_edges;
+        std::vector<std::vector<size_t>> in_edges;
+        std::vector<bool> contracted;
+        std::vector<size_t> contracted_neighbors;
+        SearchSpace witness_search;
+    };
+
+    struct Shortcut {
+        VertexId from;
+        VertexId to;
+        Weight weight;
+        size_t first;
+        size_t second;
+    };
+
+    void Contract(const Graph& graph);
+    std::vector<Shortcut> FindShortcuts(ContractionState& state, VertexId vertex) const;
+    int ComputePriority(ContractionState& state, VertexId vertex) const;
+    void BuildUpwardGraph();
+    void UnpackEdge(size_t hierarchy_edge, std::vector<EdgeId>& edges) const;
+    // Полный поиск вверх по рангам от vertex, вызывает on_settled(vertex, weight) для освоенных вершин
+    template <typename Callback>
+    void SearchUpward(SearchSpace& search, VertexId vertex, bool forward, Callback&& on_settled) const;
+
+    // Ограничение на число вершин, осваиваемых при поиске свидетеля
+    static constexpr size_t WITNESS_SETTLE_LIMIT = 500;
+    static constexpr Weight ZERO_WEIGHT{};
+
+    HierarchyData hierarchy_data_;
+    // Рёбра вверх по рангу, в формате CSR: для прямого поиска - исходящие,
+    // для обратного - входящие из вершин с большим рангом
+    std::vector<size_t> upward_out_offsets_;
+    std::vector<size_t> upward_out_edges_;
+    std::vector<size_t> upward_in_offsets_;
+    std::vector<size_t> upward_in_edges_;
+
+    mutable SearchSpace forward_search_;
+    mutable SearchSpace backward_search_;
+};
+
+template <typename Weight>
+ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph) {
+    Contract(graph);
+    BuildUpwardGraph();
+}
+
+template <typename Weight>
+ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph, HierarchyData hierarchy_data)
+    : hierarchy_data_(std::move(hierarchy_data))
+{
+    const size_t vertex_count = graph.GetVertexCount();
+    if (hierarchy_data_.ranks.size() != vertex_count) {
+        throw std::invalid_argument("Contraction hierarchy doesn't match the graph");
+    }
+    for (size_t edge_id = 0; edge_id < hierarchy_data_.edges.size(); ++edge_id) {
+        const HierarchyEdge& edge = hierarchy_data_.edges[edge_id];
+        const bool is_valid = edge.from < vertex_count && edge.to < vertex_count
+            && (edge.original_edge == NO_EDGE
+                ? edge.first < edge_id && edge.second < edge_id
+                : edge.original_edge < graph.GetEdgeCount());
+        if (!is_valid) {
+            throw std::invalid_argument("Contraction hierarchy doesn't match the graph");
+        }
+    }
+    BuildUpwardGraph();
+}
+
+template <typename Weight>
+const typename ContractionHierarchy<Weight>::HierarchyData& ContractionHierarchy<Weight>::GetHierarchyData() const {
+    return hierarchy_data_;
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::Contract(const Graph& graph) {
+    const size_t vertex_count = graph.GetVertexCount();
+    auto& edges = hierarchy_data_.edges;
+    hierarchy_data_.ranks.assign(vertex_count, 0);
+
+    // Из параллельных рёбер достаточно самого лёгкого, петли на кратчайшие пути не влияют
+    std::map<std::pair<VertexId, VertexId>, size_t> edge_by_ends;
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        for (const auto& arc : graph.GetArcs(vertex)) {
+            if (arc.weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+            if (arc.to == vertex) {
+                continue;
+            }
+            const auto [it, inserted] = edge_by_ends.emplace(std::make_pair(vertex, VertexId{ arc.to }), edges.size());
+            if (inserted) {
+                edges.push_back({ vertex, arc.to, arc.weight, arc.edge_id, 0, 0 });
+            }
+            else if (arc.weight < edges[it->second].weight) {
+                edges[it->second].weight = arc.weight;
+                edges[it->second].original_edge = arc.edge_id;
+            }
+        }
+    }
+
+    ContractionState state;
+    state.out_edges.resize(vertex_count);
+    state.in_edges.resize(vertex_count);
+    state.contracted.assign(vertex_count, false);
+    state.contracted_neighbors.assign(vertex_count, 0);
+    state.witness_search.Resize(vertex_count);
+    for (size_t edge_id = 0; edge_id < edges.size(); ++edge_id) {
+        state.out_edges[edges[edge_id].from].push_back(edge_id);
+        state.in_edges[edges[edge_id].to].push_back(edge_id);
+    }
+
+    // Ленивое обновление приоритетов: извлечённая вершина сжимается, только если
+    // её пересчитанный приоритет не хуже следующего в очереди
+    using PriorityItem = std::pair<int, VertexId>;
+    std::priority_queue<PriorityItem, std::vector<PriorityItem>, std::greater<PriorityItem>> queue;
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        queue.emplace(ComputePriority(state, vertex), vertex);
+    }
+
+    size_t rank = 0;
+    while (!queue.empty()) {
+        const VertexId vertex = queue.top().second;
+        queue.pop();
+        if (state.contracted[vertex]) {
+            continue;
+        }
+        const int priority = ComputePriority(state, vertex);
+        if (!queue.empty() && priority > queue.top().first) {
+            queue.emplace(priority, vertex);
+            continue;
+        }
+
+        for (const Shortcut& shortcut : FindShortcuts(state, vertex)) {
+            const size_t edge_id = edges.size();
+            edges.push_back({ shortcut.from, shortcut.to, shortcut.weight, NO_EDGE, shortcut.first, shortcut.second });
+            state.out_edges[shortcut.from].push_back(edge_id);
+            state.in_edges[shortcut.to].push_back(edge_id);
+        }
+
+        state.contracted[vertex] = true;
+        hierarchy_data_.ranks[vertex] = rank++;
+
+        // Соседи больше не должны видеть рёбра в сжатую вершину
+        const auto is_contracted_to = [&](size_t edge_id) { return state.contracted[edges[edge_id].to]; };
+        const auto is_contracted_from = [&](size_t edge_id) { return state.contracted[edges[edge_id].from]; };
+        for (const size_t edge_id : state.in_edges[vertex]) {
+            const VertexId neighbor = edges[edge_id].from;
+            if (!state.contracted[neighbor]) {
+                auto& neighbor_edges = state.out_edges[neighbor];
+                neighbor_edges.erase(std::remove_if(neighbor_edges.begin(), neighbor_edges.end(), is_contracted_to), neighbor_edges.end());
+                ++state.contracted_neighbors[neighbor];
+            }
+        }
+        for (const size_t edge_id : state.out_edges[vertex]) {
+            const VertexId neighbor = edges[edge_id].to;
+            if (!state.contracted[neighbor]) {
+                auto& neighbor_edges = state.in_edges[neighbor];
+                neighbor_edges.erase(std::remove_if(neighbor_edges.begin(), neighbor_edges.end(), is_contracted_from), neighbor_edges.end());
+                ++state.contracted_neighbors[neighbor];
+            }
+        }
+        std::vector<size_t>().swap(state.out_edges[vertex]);
+        std::vector<size_t>().swap(state.in_edges[vertex]);
+    }
+}
+
+template <typename Weight>
+std::vector<typename ContractionHierarchy<Weight>::Shortcut> ContractionHierarchy<Weight>::FindShortcuts(
+    ContractionState& state, VertexId vertex) const {
+    const auto& edges = hierarchy_data_.edges;
+    std::vector<Shortcut> shortcuts;
+    SearchSpace& search = state.witness_search;
+
+    for (const size_t in_edge_id : state.in_edges[vertex]) {
+        const HierarchyEdge& in_edge = edges[in_edge_id];
+        const VertexId source = in_edge.from;
+        if (state.contracted[source]) {
+            continue;
+        }
+        Weight max_weight = ZERO_WEIGHT;
+        bool has_targets = false;
+        for (const size_t out_edge_id : state.out_edges[vertex]) {
+            const HierarchyEdge& out_edge = edges[out_edge_id];
+            if (out_edge.to != source && !state.contracted[out_edge.to]) {
+                max_weight = std::max(max_weight, in_edge.weight + out_edge.weight);
+                has_targets = true;
+            }
+        }
+        if (!has_targets) {
+            continue;
+        }
+
+        // Поиск свидетеля: путь от source в обход vertex не длиннее пути через vertex
+        search.Reset();
+        search.Push(source, ZERO_WEIGHT, NO_EDGE);
+        size_t settled_count = 0;
+        while (const auto item = search.Pop()) {
+            const auto [weight, current] = *item;
+            if (weight > max_weight || ++settled_count > WITNESS_SETTLE_LIMIT) {
+                break;
+            }
+            for (const size_t edge_id : state.out_edges[current]) {
+                const HierarchyEdge& edge = edges[edge_id];
+                if (edge.to == vertex || state.contracted[edge.to]) {
+                    continue;
+                }
+                const Weight candidate_weight = weight + edge.weight;
+                if (search.Improves(edge.to, candidate_weight)) {
+                    search.Push(edge.to, candidate_weight, edge_id);
+                }
+            }
+        }
+
+        for (const size_t out_edge_id : state.out_edges[vertex]) {
+            const HierarchyEdge& out_edge = edges[out_edge_id];
+            const VertexId target = out_edge.to;
+            if (target == source || state.contracted[target]) {
+                continue;
+            }
+            const Weight shortcut_weight = in_edge.weight + out_edge.weight;
+            if (!search.reached[target] || shortcut_weight < search.distances[target]) {
+                shortcuts.push_back({ source, target, shortcut_weight, in_edge_id, out_edge_id });
+            }
+        }
+    }
+    return shortcuts;
+}
+
+template <typename Weight>
+int ContractionHierarchy<Weight>::ComputePriority(ContractionState& state, VertexId vertex) const {
+    const int shortcut_count = static_cast<int>(FindShortcuts(state, vertex).size());
+    const int removed_count = static_cast<int>(state.in_edges[vertex].size() + state.out_edges[vertex].size());
+    return shortcut_count - removed_count + static_cast<int>(state.contracted_neighbors[vertex]);
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::BuildUpwardGraph() {
+    const auto& ranks = hierarchy_data_.ranks;
+    const auto& edges = hierarchy_data_.edges;
+    const size_t vertex_count = ranks.size();
+
+    upward_out_offsets_.assign(vertex_count + 1, 0);
+    upward_in_offsets_.assign(vertex_count + 1, 0);
+    for (const HierarchyEdge& edge : edges) {
+        if (ranks[edge.from] < ranks[edge.to]) ++upward_out_offsets_[edge.from + 1];
+        else ++upward_in_offsets_[edge.to + 1];
+    }
+    for (size_t vertex = 0; vertex < vertex_count; ++vertex) {
+        upward_out_offsets_[vertex + 1] += upward_out_offsets_[vertex];
+        upward_in_offsets_[vertex + 1] += upward_in_offsets_[vertex];
+    }
+    upward_out_edges_.resize(upward_out_offsets_.back());
+    upward_in_edges_.resize(upward_in_offsets_.back());
+    std::vector<size_t> out_positions(upward_out_offsets_.begin(), upward_out_offsets_.end() - 1);
+    std::vector<size_t> in_positions(upward_in_offsets_.begin(), upward_in_offsets_.end() - 1);
+    for (size_t edge_id = 0; edge_id < edges.size(); ++edge_id) {
+        const HierarchyEdge& edge = edges[edge_id];
+        if (ranks[edge.from] < ranks[edge.to]) upward_out_edges_[out_positions[edge.from]++] = edge_id;
+        else upward_in_edges_[in_positions[edge.to]++] = edge_id;
+    }
+
+    forward_search_.Resize(vertex_count);
+    backward_search_.Resize(vertex_count);
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::UnpackEdge(size_t hierarchy_edge, std::vector<EdgeId>& edges) const {
+    std::vector<size_t> stack = { hierarchy_edge };
+    while (!stack.empty()) {
+        const HierarchyEdge& edge = hierarchy_data_.edges[stack.back()];
+        stack.pop_back();
+        if (edge.original_edge != NO_EDGE) {
+            edges.push_back(edge.original_edge);
+        }
+        else {
+            stack.push_back(edge.second);
+            stack.push_back(edge.first);
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename ContractionHierarchy<Weight>::RouteInfo> ContractionHierarchy<Weight>::BuildRoute(VertexId from,
+    VertexId to) const {
+    const size_t vertex_count = hierarchy_data_.ranks.size();
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex is out of graph");
+    }
+    const auto& edges = hierarchy_data_.edges;
+    forward_search_.Reset();
+    backward_search_.Reset();
+    forward_search_.Push(from, ZERO_WEIGHT, NO_EDGE);
+    backward_search_.Push(to, ZERO_WEIGHT, NO_EDGE);
+
+    std::optional<Weight> best_weight;
+    VertexId meeting_vertex = from;
+    const auto update_best = [&](VertexId vertex) {
+        if (forward_search_.settled[vertex] && backward_search_.settled[vertex]) {
+            const Weight weight = forward_search_.distances[vertex] + backward_search_.distances[vertex];
+            if (!best_weight || weight < *best_weight) {
+                best_weight = weight;
+                meeting_vertex = vertex;
+            }
+        }
+    };
+    // Поиск в одном направлении прекращается, когда его минимум не меньше лучшего найденного пути
+    const auto is_finished = [&](const SearchSpace& search) {
+        return search.queue.empty() || (best_weight && !(search.queue.front().first < *best_weight));
+    };
+
+    bool forward_turn = true;
+    while (!is_finished(forward_search_) || !is_finished(backward_search_)) {
+        if (is_finished(forward_search_)) forward_turn = false;
+        else if (is_finished(backward_search_)) forward_turn = true;
+
+        SearchSpace& search = forward_turn ? forward_search_ : backward_search_;
+        const auto& offsets = forward_turn ? upward_out_offsets_ : upward_in_offsets_;
+        const auto& upward_edges = forward_turn ? upward_out_edges_ : upward_in_edges_;
+        if (const auto item = search.Pop()) {
+            const auto [weight, vertex] = *item;
+            update_best(vertex);
+            for (size_t i = offsets[vertex]; i < offsets[vertex + 1]; ++i) {
+                const HierarchyEdge& edge = edges[upward_edges[i]];
+                const VertexId next = forward_turn ? edge.to : edge.from;
+                const Weight candidate_weight = weight + edge.weight;
+                if (search.Improves(next, candidate_weight)) {
+                    search.Push(next, candidate_weight, upward_edges[i]);
+                }
+            }
+        }
+        forward_turn = !forward_turn;
+    }
+
+    if (!best_weight) {
+        return std::nullopt;
+    }
+
+    std::vector<size_t> forward_edges;
+    for (VertexId vertex = meeting_vertex; forward_search_.parent_edges[vertex] != NO_EDGE;) {
+        forward_edges.push_back(forward_search_.parent_edges[vertex]);
+        vertex = edges[forward_search_.parent_edges[vertex]].from;
+    }
+    std::vector<EdgeId> route_edges;
+    for (auto it = forward_edges.rbegin(); it != forward_edges.rend(); ++it) {
+        UnpackEdge(*it, route_edges);
+    }
+    for (VertexId vertex = meeting_vertex; backward_search_.parent_edges[vertex] != NO_EDGE;) {
+        UnpackEdge(backward_search_.parent_edges[vertex], route_edges);
+        vertex = edges[backward_search_.parent_edges[vertex]].to;
+    }
+
+    return RouteInfo{ *best_weight, std::move(route_edges) };
+}
+
+template <typename Weight>
+template <typename Callback>
+void ContractionHierarchy<Weight>::SearchUpward(SearchSpace& search, VertexId vertex, bool forward,
+    Callback&& on_settled) const {
+    const auto& edges = hierarchy_data_.edges;
+    const auto& offsets = forward ? upward_out_offsets_ : upward_in_offsets_;
+    const auto& upward_edges = forward ? upward_out_edges_ : upward_in_edges_;
+    search.Reset();
+    search.Push(vertex, ZERO_WEIGHT, NO_EDGE);
+    while (const auto item = search.Pop()) {
+        const auto [weight, current] = *item;
+        on_settled(current, weight);
+        for (size_t i = offsets[current]; i < offsets[current + 1]; ++i) {
+            const HierarchyEdge& edge = edges[upward_edges[i]];
+            const VertexId next = forward ? edge.to : edge.from;
+            const Weight candidate_weight = weight + edge.weight;
+            if (search.Improves(next, candidate_weight)) {
+                search.Push(next, candidate_weight, upward_edges[i]);
+            }
+        }
+    }
+}
+
+template <typename Weight>
+std::vector<std::vector<std::optional<Weight>>> ContractionHierarchy<Weight>::BuildWeightMatrix(
+    const std::vector<VertexId>& sources, const std::vector<VertexId>& targets) const {
+    const size_t vertex_count = hierarchy_data_.ranks.size();
+    const auto check_vertex = [vertex_count](VertexId vertex) {
+        if (vertex >= vertex_count) {
+            throw std::out_of_range("Vertex is out of graph");
+        }
+    };
+
+    // Корзина вершины: пары (номер в targets, расстояние от вершины до него)
+    using BucketItem = std::pair<size_t, Weight>;
+    std::vector<std::vector<BucketItem>> buckets(vertex_count);
+    for (size_t target_index = 0; target_index < targets.size(); ++target_index) {
+        check_vertex(targets[target_index]);
+        SearchUpward(backward_search_, targets[target_index], false, [&](VertexId vertex, Weight weight) {
+            buckets[vertex].emplace_back(target_index, weight);
+        });
+    }
+
+    std::vector<std::vector<std::optional<Weight>>> matrix;
+    matrix.reserve(sources.size());
+    for (const VertexId from : sources) {
+        check_vertex(from);
+        auto& row = matrix.emplace_back(targets.size());
+        SearchUpward(forward_search_, from, true, [&](VertexId vertex, Weight weight) {
+            for (const auto& [target_index, target_weight] : buckets[vertex]) {
+                const Weight candidate_weight = weight + target_weight;
+                if (!row[target_index] || candidate_weight < *row[target_index]) {
+                    row[target_index] = candidate_weight;
+                }
+            }
+        });
+    }
+    return matrix;
+}
+
+}  // namespace graph
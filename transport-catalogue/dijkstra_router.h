@@ -0,0 +1,228 @@
+#pragma once
+
+#include "router.h"
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Маршрутизатор без предрасчёта: каждый запрос обслуживается отдельным
+// поиском Дейкстры. Память линейна по числу вершин, буферы переиспользуются
+// между запросами, поэтому один экземпляр нельзя использовать из разных потоков.
+template <typename Weight>
+class DijkstraRouter {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using RouteInfo = typename Router<Weight>::RouteInfo;
+
+    explicit DijkstraRouter(const Graph& graph);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+    // Поиск A*: heuristic(vertex) - нижняя оценка веса пути из vertex в to.
+    // Оценка должна быть согласованной: h(u) <= w(u, v) + h(v) для каждого ребра
+    template <typename Heuristic>
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to, Heuristic&& heuristic) const;
+    // Одно дерево поиска на каждую вершину из sources; поиск останавливается,
+    // как только освоены все вершины из targets
+    std::vector<std::vector<std::optional<Weight>>> BuildWeightMatrix(const std::vector<VertexId>& sources,
+        const std::vector<VertexId>& targets) const;
+    // Все вершины, достижимые из from с весом пути не больше max_weight, в порядке возрастания веса.
+    // Поиск не раскрывает вершины дальше max_weight
+    std::vector<std::pair<VertexId, Weight>> BuildReachable(VertexId from, Weight max_weight) const;
+
+private:
+    // Ключ очереди - вес пути до вершины плюс оценка остатка пути
+    using QueueItem = std::pair<Weight, VertexId>;
+
+    void ResetSearch() const {
+        for (const VertexId vertex : touched_vertices_) {
+            reached_[vertex] = false;
+            settled_[vertex] = false;
+        }
+        touched_vertices_.clear();
+        queue_.clear();
+    }
+
+    void Push(VertexId vertex, Weight weight, std::optional<EdgeId> prev_edge, Weight key) const {
+        if (!reached_[vertex]) {
+            reached_[vertex] = true;
+            touched_vertices_.push_back(vertex);
+        }
+        distances_[vertex] = weight;
+        prev_edges_[vertex] = prev_edge;
+        queue_.emplace_back(key, vertex);
+        std::push_heap(queue_.begin(), queue_.end(), std::greater<QueueItem>{});
+    }
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+
+    mutable std::vector<Weight> distances_;
+    mutable std::vector<std::optional<EdgeId>> prev_edges_;
+    mutable std::vector<bool> reached_;
+    mutable std::vector<bool> settled_;
+    mutable std::vector<VertexId> touched_vertices_;
+    mutable std::vector<QueueItem> queue_;
+};
+
+template <typename Weight>
+DijkstraRouter<Weight>::DijkstraRouter(const Graph& graph)
+    : graph_(graph)
+    , distances_(graph.GetVertexCount())
+    , prev_edges_(graph.GetVertexCount())
+    , reached_(graph.GetVertexCount())
+    , settled_(graph.GetVertexCount())
+{
+    for (VertexId vertex = 0; vertex < graph.GetVertexCount(); ++vertex) {
+        for (const auto& arc : graph.GetArcs(vertex)) {
+            if (arc.weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename DijkstraRouter<Weight>::RouteInfo> DijkstraRouter<Weight>::BuildRoute(VertexId from,
+    VertexId to) const {
+    return BuildRoute(from, to, [](VertexId) { return ZERO_WEIGHT; });
+}
+
+template <typename Weight>
+template <typename Heuristic>
+std::optional<typename DijkstraRouter<Weight>::RouteInfo> DijkstraRouter<Weight>::BuildRoute(VertexId from,
+    VertexId to, Heuristic&& heuristic) const {
+    if (from >= graph_.GetVertexCount() || to >= graph_.GetVertexCount()) {
+        throw std::out_of_range("Vertex is out of graph");
+    }
+    ResetSearch();
+    Push(from, ZERO_WEIGHT, std::nullopt, heuristic(from));
+
+    while (!queue_.empty()) {
+        std::pop_heap(queue_.begin(), queue_.end(), std::greater<QueueItem>{});
+        const VertexId vertex = queue_.back().second;
+        queue_.pop_back();
+        if (settled_[vertex]) {
+            continue;
+        }
+        settled_[vertex] = true;
+        if (vertex == to) {
+            break;
+        }
+        const Weight weight = distances_[vertex];
+        for (const auto& arc : graph_.GetArcs(vertex)) {
+            const Weight candidate_weight = weight + arc.weight;
+            if (!reached_[arc.to] || (!settled_[arc.to] && candidate_weight < distances_[arc.to])) {
+                Push(arc.to, candidate_weight, arc.edge_id, candidate_weight + heuristic(arc.to));
+            }
+        }
+    }
+
+    if (!settled_[to]) {
+        return std::nullopt;
+    }
+    std::vector<EdgeId> edges;
+    for (std::optional<EdgeId> edge_id = prev_edges_[to];
+        edge_id;
+        edge_id = prev_edges_[graph_.GetEdge(*edge_id).from])
+    {
+        edges.push_back(*edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return RouteInfo{ distances_[to], std::move(edges) };
+}
+
+template <typename Weight>
+std::vector<std::vector<std::optional<Weight>>> DijkstraRouter<Weight>::BuildWeightMatrix(
+    const std::vector<VertexId>& sources, const std::vector<VertexId>& targets) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    std::vector<bool> is_target(vertex_count, false);
+    size_t target_count = 0;
+    for (const VertexId target : targets) {
+        if (target >= vertex_count) {
+            throw std::out_of_range("Vertex is out of graph");
+        }
+        if (!is_target[target]) {
+            is_target[target] = true;
+            ++target_count;
+        }
+    }
+
+    std::vector<std::vector<std::optional<Weight>>> matrix;
+    matrix.reserve(sources.size());
+    for (const VertexId from : sources) {
+        if (from >= vertex_count) {
+            throw std::out_of_range("Vertex is out of graph");
+        }
+        ResetSearch();
+        Push(from, ZERO_WEIGHT, std::nullopt, ZERO_WEIGHT);
+        size_t remaining_targets = target_count;
+        while (!queue_.empty() && remaining_targets > 0) {
+            std::pop_heap(queue_.begin(), queue_.end(), std::greater<QueueItem>{});
+            const auto [weight, vertex] = queue_.back();
+            queue_.pop_back();
+            if (settled_[vertex]) {
+                continue;
+            }
+            settled_[vertex] = true;
+            if (is_target[vertex]) {
+                --remaining_targets;
+            }
+            for (const auto& arc : graph_.GetArcs(vertex)) {
+                const Weight candidate_weight = weight + arc.weight;
+                if (!reached_[arc.to] || (!settled_[arc.to] && candidate_weight < distances_[arc.to])) {
+                    Push(arc.to, candidate_weight, arc.edge_id, candidate_weight);
+                }
+            }
+        }
+
+        auto& row = matrix.emplace_back(targets.size());
+        for (size_t i = 0; i < targets.size(); ++i) {
+            if (settled_[targets[i]]) {
+                row[i] = distances_[targets[i]];
+            }
+        }
+    }
+    return matrix;
+}
+
+template <typename Weight>
+std::vector<std::pair<VertexId, Weight>> DijkstraRouter<Weight>::BuildReachable(VertexId from, Weight max_weight) const {
+    if (from >= graph_.GetVertexCount()) {
+        throw std::out_of_range("Vertex is out of graph");
+    }
+    std::vector<std::pair<VertexId, Weight>> reachable;
+    ResetSearch();
+    Push(from, ZERO_WEIGHT, std::nullopt, ZERO_WEIGHT);
+    while (!queue_.empty()) {
+        std::pop_heap(queue_.begin(), queue_.end(), std::greater<QueueItem>{});
+        const auto [weight, vertex] = queue_.back();
+        queue_.pop_back();
+        if (settled_[vertex]) {
+            continue;
+        }
+        if (max_weight < weight) {
+            break;
+        }
+        settled_[vertex] = true;
+        reachable.emplace_back(vertex, weight);
+        for (const auto& arc : graph_.GetArcs(vertex)) {
+            const Weight candidate_weight = weight + arc.weight;
+            if (!(max_weight < candidate_weight)
+                && (!reached_[arc.to] || (!settled_[arc.to] && candidate_weight < distances_[arc.to]))) {
+                Push(arc.to, candidate_weight, arc.edge_id, candidate_weight);
+            }
+        }
+    }
+    return reachable;
+}
+
+}  // namespace graph
@@ -2,23 +2,23 @@
 
 #include "geo.h"
 
-#include <string>
+#include <cstdint>
+#include <optional>
+#include <string_view>
 #include <vector>
-#include <set>
 #include <unordered_map>
 
 namespace transport {
 
+// id - плотные номера остановок и автобусов в порядке добавления в каталог.
+// Названия и номера ссылаются на хранилище имён каталога
 struct Stop {
-    std::string name;
+    uint32_t id;
+    std::string_view name;
     geo::Coordinates coordinates;
-    std::set<std::string> buses_by_stop;
-};
-
-struct Bus {
-    std::string number;
-    std::vector<const Stop*> stops;
-    bool is_circle;
+    // Номера автобусов через остановку, отсортированы и без повторов после Catalogue::Finalize;
+    // ссылаются на Bus::number
+    std::vector<std::string_view> buses_by_stop;
 };
 
 struct BusStat {
@@ -28,4 +28,36 @@ struct BusStat {
     double curvature;
 };
 
+struct Bus {
+    uint32_t id;
+    std::string_view number;
+    std::vector<const Stop*> stops;
+    bool is_circle;
+    // Префиксные суммы дорожных расстояний, заполняются каталогом:
+    // forward_distances[i] - путь от stops[0] до stops[i] по ходу маршрута,
+    // backward_distances[i] - путь от stops[i] до stops[0] против хода маршрута
+    std::vector<int> forward_distances = {};
+    std::vector<int> backward_distances = {};
+    // Статистика маршрута, считается в Catalogue::Finalize, если не загружена из базы
+    std::optional<BusStat> stat = std::nullopt;
+};
+
+// Элемент маршрута: ожидание на остановке или поездка на автобусе через span_count перегонов.
+// name_id - номер названия остановки или номера автобуса в таблице имён маршрутизатора
+struct RouteItem {
+    enum class Type {
+        WAIT,
+        BUS
+    };
+    Type type;
+    uint32_t name_id;
+    size_t span_count;
+    double time;
+};
+
+struct RouteInfo {
+    double total_time = 0.0;
+    std::vector<RouteItem> items;
+};
+
 } // namespace transport
\ No newline at end of file
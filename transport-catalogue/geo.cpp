@@ -3,19 +3,131 @@
 #include "geo.h"
 
 #include <cmath>
+#include <stdexcept>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define GEO_HAS_AVX2_KERNEL
+#include <immintrin.h>
+#endif
 
 namespace geo {
 
+namespace {
+
+const double dr = M_PI / 180.;
+
+// sin_a * sin_b + cos_a * cos_b * cos(dlng) в том же порядке операций, что и в ComputeDistance.
+// На входе cosines[i] - косинус разности долгот отрезка, на выходе - косинус угла между точками
+void ComputeCosinesScalar(const PointArrays& points, const uint32_t* from, const uint32_t* to,
+    double* cosines, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t a = from[i];
+        const uint32_t b = to[i];
+        cosines[i] = points.sin_lat[a] * points.sin_lat[b] + points.cos_lat[a] * points.cos_lat[b] * cosines[i];
+    }
+}
+
+#ifdef GEO_HAS_AVX2_KERNEL
+// Gather с явным нулевым источником и полной маской: у _mm256_i32gather_pd источник не
+// инициализирован, и GCC предупреждает об этом под -Wall
+__attribute__((target("avx2")))
+inline __m256d Gather(const std::vector<double>& values, __m128i indices) {
+    const __m256d all_lanes = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    return _mm256_mask_i32gather_pd(_mm256_setzero_pd(), values.data(), indices, all_lanes, 8);
+}
+
+// Без FMA: раздельные умножение и сложение дают те же результаты, что и скалярный код
+__attribute__((target("avx2")))
+void ComputeCosinesAvx2(const PointArrays& points, const uint32_t* from, const uint32_t* to,
+    double* cosines, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(to + i));
+        const __m256d result = _mm256_add_pd(
+            _mm256_mul_pd(Gather(points.sin_lat, a), Gather(points.sin_lat, b)),
+            _mm256_mul_pd(_mm256_mul_pd(Gather(points.cos_lat, a), Gather(points.cos_lat, b)), _mm256_loadu_pd(cosines + i)));
+        _mm256_storeu_pd(cosines + i, result);
+    }
+    // Хвостовой вызов GCC делает без vzeroupper, и грязные верхние половины регистров
+    // замедляют SSE-код libm (acos, cos) во всём процессе в несколько раз
+    _mm256_zeroupper();
+    ComputeCosinesScalar(points, from + i, to + i, cosines + i, count - i);
+}
+
+bool HasAvx2() {
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    return has_avx2;
+}
+#endif
+
+} // namespace
+
 double ComputeDistance(Coordinates from, Coordinates to) {
     using namespace std;
     if (from == to) {
         return 0;
     }
-    static const double dr = M_PI / 180.;
-    static const int earth_rd = 6371000;
     return acos(sin(from.lat * dr) * sin(to.lat * dr)
         + cos(from.lat * dr) * cos(to.lat * dr) * cos(abs(from.lng - to.lng) * dr))
-        * earth_rd;
+        * EARTH_RADIUS;
+}
+
+void PointArrays::Add(Coordinates coordinates) {
+    using namespace std;
+    lat.push_back(coordinates.lat);
+    lng.push_back(coordinates.lng);
+    sin_lat.push_back(sin(coordinates.lat * dr));
+    cos_lat.push_back(cos(coordinates.lat * dr));
+}
+
+size_t PointArrays::Size() const {
+    return lat.size();
+}
+
+void ComputeDistances(const PointArrays& points, const std::vector<uint32_t>& from,
+    const std::vector<uint32_t>& to, std::vector<double>& distances) {
+    if (from.size() != to.size()) {
+        throw std::invalid_argument("Segment ends don't match");
+    }
+    const size_t count = from.size();
+    // Косинус разности долгот считается скалярно, как в ComputeDistance: произведения
+    // предвычисленных синусов и косинусов долгот расходятся с ним в последних битах,
+    // а acos близкого к единице аргумента увеличивает это расхождение на коротких отрезках
+    distances.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        distances[i] = std::cos(std::abs(points.lng[from[i]] - points.lng[to[i]]) * dr);
+    }
+#ifdef GEO_HAS_AVX2_KERNEL
+    // Индексы собираются 32-битными gather, поэтому точек должно быть не больше INT32_MAX
+    if (HasAvx2() && points.Size() <= static_cast<size_t>(INT32_MAX)) {
+        ComputeCosinesAvx2(points, from.data(), to.data(), distances.data(), count);
+    }
+    else
+#endif
+    {
+        ComputeCosinesScalar(points, from.data(), to.data(), distances.data(), count);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t a = from[i];
+        const uint32_t b = to[i];
+        const bool is_same_point = points.lat[a] == points.lat[b] && points.lng[a] == points.lng[b];
+        distances[i] = is_same_point ? 0 : std::acos(distances[i]) * EARTH_RADIUS;
+    }
+}
+
+UnitVector ToUnitVector(Coordinates coordinates) {
+    using namespace std;
+    const double lat = coordinates.lat * dr;
+    const double lng = coordinates.lng * dr;
+    return { cos(lat) * cos(lng), cos(lat) * sin(lng), sin(lat) };
+}
+
+double ComputeChordDistance(const UnitVector& from, const UnitVector& to) {
+    const double dx = from.x - to.x;
+    const double dy = from.y - to.y;
+    const double dz = from.z - to.z;
+    return std::sqrt(dx * dx + dy * dy + dz * dz) * EARTH_RADIUS;
 }
 
 } // namespace geo
\ No newline at end of file
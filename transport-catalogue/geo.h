@@ -1,9 +1,15 @@
 #pragma once
 
 #include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
 
 namespace geo {
 
+// Радиус Земли в метрах, которым пользуются все расчёты расстояний
+const int EARTH_RADIUS = 6371000;
+
 struct Coordinates {
     double lat;
     double lng;
@@ -17,4 +23,33 @@ struct Coordinates {
 
 double ComputeDistance(Coordinates from, Coordinates to);
 
+// Точки в виде структуры массивов: координаты в градусах, синус и косинус широты
+// считаются один раз при добавлении точки
+struct PointArrays {
+    std::vector<double> lat;
+    std::vector<double> lng;
+    std::vector<double> sin_lat;
+    std::vector<double> cos_lat;
+
+    void Add(Coordinates coordinates);
+    size_t Size() const;
+};
+
+// Пакетный расчёт: distances[i] совпадает до бита с ComputeDistance для точек from[i] и to[i].
+// На отрезок остаются cos разности долгот и acos вместо шести функций; на процессорах с AVX2
+// косинус угла между точками считается по четыре отрезка сразу
+void ComputeDistances(const PointArrays& points, const std::vector<uint32_t>& from,
+    const std::vector<uint32_t>& to, std::vector<double>& distances);
+
+// Точка поверхности Земли как вектор единичной длины из центра
+struct UnitVector {
+    double x;
+    double y;
+    double z;
+};
+
+UnitVector ToUnitVector(Coordinates coordinates);
+// Расстояние по прямой (хорда) в метрах, не больше расстояния по поверхности
+double ComputeChordDistance(const UnitVector& from, const UnitVector& to);
+
 }  // namespace geo
\ No newline at end of file
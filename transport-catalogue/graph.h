@@ -2,29 +2,111 @@
 
 #include "ranges.h"
 
+#include <cstddef>
+#include <cstdint>
 #include <cstdlib>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <utility>
 #include <vector>
-#include <string>
 
 namespace graph {
 
 using VertexId = size_t;
 using EdgeId = size_t;
 
+// Вес недостижимой вершины: бесконечность для вещественных весов. У целых весов бесконечности нет,
+// поэтому берётся половина максимума: сумма двух таких весов не переполняется и не меньше ни одного из них
+template <typename Weight>
+constexpr Weight GetUnreachableWeight() {
+    if constexpr (std::numeric_limits<Weight>::has_infinity) {
+        return std::numeric_limits<Weight>::infinity();
+    }
+    else {
+        return std::numeric_limits<Weight>::max() / 2;
+    }
+}
+
+// name_id - номер имени ребра в таблице имён, которой владеет пользователь графа
 template <typename Weight>
 struct Edge {
-    std::string name;
+    uint32_t name_id;
     size_t quality;
     VertexId from;
     VertexId to;
     Weight weight;
 };
 
+// Исходящее ребро в компактном виде: всё, что нужно поиску, без имени и прочих данных ребра
+template <typename Weight>
+struct Arc {
+    uint32_t to;
+    uint32_t edge_id;
+    Weight weight;
+};
+
+// Данные ребра, не нужные поиску: хранятся отдельно от Arc по номеру ребра.
+// arc_index - позиция ребра в массиве исходящих рёбер замороженного графа
+struct EdgeInfo {
+    uint32_t name_id;
+    uint32_t quality;
+    uint32_t from;
+    uint32_t arc_index;
+};
+
+// Номера исходящих рёбер вершины: до заморозки - из списка смежности, после - из Arc
+template <typename Weight>
+class IncidentEdgeIterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = EdgeId;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const EdgeId*;
+    using reference = EdgeId;
+
+    explicit IncidentEdgeIterator(const EdgeId* edge_id)
+        : edge_id_(edge_id) {
+    }
+    explicit IncidentEdgeIterator(const Arc<Weight>* arc)
+        : arc_(arc) {
+    }
+
+    EdgeId operator*() const {
+        return arc_ ? arc_->edge_id : *edge_id_;
+    }
+    IncidentEdgeIterator& operator++() {
+        if (arc_) {
+            ++arc_;
+        }
+        else {
+            ++edge_id_;
+        }
+        return *this;
+    }
+    IncidentEdgeIterator operator++(int) {
+        IncidentEdgeIterator result = *this;
+        ++*this;
+        return result;
+    }
+    bool operator==(const IncidentEdgeIterator& other) const {
+        return edge_id_ == other.edge_id_ && arc_ == other.arc_;
+    }
+    bool operator!=(const IncidentEdgeIterator& other) const {
+        return !(*this == other);
+    }
+
+private:
+    const EdgeId* edge_id_ = nullptr;
+    const Arc<Weight>* arc_ = nullptr;
+};
+
 template <typename Weight>
 class DirectedWeightedGraph {
 private:
     using IncidenceList = std::vector<EdgeId>;
-    using IncidentEdgesRange = ranges::Range<typename IncidenceList::const_iterator>;
+    using IncidentEdgesRange = ranges::Range<IncidentEdgeIterator<Weight>>;
+    using ArcsRange = ranges::Range<typename std::vector<Arc<Weight>>::const_iterator>;
 
 public:
     DirectedWeightedGraph() = default;
@@ -33,14 +115,29 @@ public:
         std::vector<std::vector<EdgeId>> incidence_lists);
     EdgeId AddEdge(const Edge<Weight>& edge);
 
+    // Переводит граф в неизменяемый формат CSR: исходящие рёбра всех вершин лежат подряд
+    // в одном массиве Arc, прочие данные рёбер - в отдельном массиве EdgeInfo. После этого
+    // рёбра добавлять нельзя, зато доступен GetArcs
+    void Freeze();
+    bool IsFrozen() const;
+
     size_t GetVertexCount() const;
     size_t GetEdgeCount() const;
-    const Edge<Weight>& GetEdge(EdgeId edge_id) const;
+    // У замороженного графа ребро собирается из Arc и EdgeInfo, поэтому возвращается копия
+    Edge<Weight> GetEdge(EdgeId edge_id) const;
     IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
+    ArcsRange GetArcs(VertexId vertex) const;
 
 private:
     std::vector<Edge<Weight>> edges_;
     std::vector<IncidenceList> incidence_lists_;
+
+    // Формат CSR: рёбра вершины v занимают [offsets_[v], offsets_[v + 1]) в arcs_.
+    // edges_ и incidence_lists_ после заморозки освобождаются
+    bool is_frozen_ = false;
+    std::vector<size_t> offsets_;
+    std::vector<Arc<Weight>> arcs_;
+    std::vector<EdgeInfo> edge_infos_;
 };
 
 template <typename Weight>
@@ -51,37 +148,97 @@ DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count)
 template <typename Weight>
 DirectedWeightedGraph<Weight>::DirectedWeightedGraph(std::vector<Edge<Weight>> edges,
     std::vector<std::vector<EdgeId>> incidence_lists)
-    : edges_(edges)
-    , incidence_lists_(incidence_lists) {
+    : edges_(std::move(edges))
+    , incidence_lists_(std::move(incidence_lists)) {
 }
 
 template <typename Weight>
 EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
+    if (is_frozen_) {
+        throw std::logic_error("Can't add edge to frozen graph");
+    }
     edges_.push_back(edge);
     const EdgeId id = edges_.size() - 1;
     incidence_lists_.at(edge.from).push_back(id);
     return id;
 }
 
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::Freeze() {
+    if (is_frozen_) {
+        return;
+    }
+    constexpr size_t max_id = std::numeric_limits<uint32_t>::max();
+    const size_t vertex_count = incidence_lists_.size();
+    if (edges_.size() > max_id || vertex_count > max_id) {
+        throw std::length_error("Too many edges for frozen graph");
+    }
+    offsets_.assign(vertex_count + 1, 0);
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        offsets_[vertex + 1] = offsets_[vertex] + incidence_lists_[vertex].size();
+    }
+    arcs_.reserve(offsets_.back());
+    edge_infos_.resize(edges_.size());
+    for (const auto& incidence_list : incidence_lists_) {
+        for (const EdgeId edge_id : incidence_list) {
+            const Edge<Weight>& edge = edges_.at(edge_id);
+            if (edge.quality > max_id) {
+                throw std::length_error("Edge quality is too large for frozen graph");
+            }
+            edge_infos_[edge_id] = { edge.name_id, static_cast<uint32_t>(edge.quality), static_cast<uint32_t>(edge.from),
+                                     static_cast<uint32_t>(arcs_.size()) };
+            arcs_.push_back({ static_cast<uint32_t>(edge.to), static_cast<uint32_t>(edge_id), edge.weight });
+        }
+    }
+    std::vector<Edge<Weight>>().swap(edges_);
+    std::vector<IncidenceList>().swap(incidence_lists_);
+    is_frozen_ = true;
+}
+
+template <typename Weight>
+bool DirectedWeightedGraph<Weight>::IsFrozen() const {
+    return is_frozen_;
+}
+
 template <typename Weight>
 size_t DirectedWeightedGraph<Weight>::GetVertexCount() const {
-    return incidence_lists_.size();
+    return is_frozen_ ? offsets_.size() - 1 : incidence_lists_.size();
 }
 
 template <typename Weight>
 size_t DirectedWeightedGraph<Weight>::GetEdgeCount() const {
-    return edges_.size();
+    return is_frozen_ ? edge_infos_.size() : edges_.size();
 }
 
 template <typename Weight>
-const Edge<Weight>& DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const {
-    return edges_.at(edge_id);
+Edge<Weight> DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const {
+    if (!is_frozen_) {
+        return edges_.at(edge_id);
+    }
+    const EdgeInfo& info = edge_infos_.at(edge_id);
+    const Arc<Weight>& arc = arcs_[info.arc_index];
+    return { info.name_id, info.quality, info.from, arc.to, arc.weight };
 }
 
 template <typename Weight>
 typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
     DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
-    return ranges::AsRange(incidence_lists_.at(vertex));
+    using Iterator = IncidentEdgeIterator<Weight>;
+    if (is_frozen_) {
+        return IncidentEdgesRange{ Iterator(arcs_.data() + offsets_.at(vertex)),
+                                   Iterator(arcs_.data() + offsets_.at(vertex + 1)) };
+    }
+    const IncidenceList& incidence_list = incidence_lists_.at(vertex);
+    return IncidentEdgesRange{ Iterator(incidence_list.data()), Iterator(incidence_list.data() + incidence_list.size()) };
+}
+
+template <typename Weight>
+typename DirectedWeightedGraph<Weight>::ArcsRange
+    DirectedWeightedGraph<Weight>::GetArcs(VertexId vertex) const {
+    if (!is_frozen_) {
+        throw std::logic_error("Graph should be frozen");
+    }
+    return ArcsRange{ arcs_.begin() + offsets_[vertex], arcs_.begin() + offsets_[vertex + 1] };
 }
 
 } // namespace graph
@@ -1,6 +1,9 @@
 #include "json_reader.h"
 #include "json_builder.h"
 
+#include <algorithm>
+#include <limits>
+
 using namespace std::literals;
 
 const json::Node& JsonReader::GetBaseRequests() const {
@@ -37,6 +40,9 @@ void JsonReader::ProcessRequests(const json::Node& stat_requests, RequestHandler
         if (type == "Bus"s) result.push_back(PrintRoute(request_map, rh).AsDict());
         if (type == "Map"s) result.push_back(PrintMap(request_map, rh).AsDict());
         if (type == "Route"s) result.push_back(PrintRouting(request_map, rh).AsDict());
+        if (type == "RouteMatrix"s) result.push_back(PrintRouteMatrix(request_map, rh).AsDict());
+        if (type == "Isochrone"s) result.push_back(PrintIsochrone(request_map, rh).AsDict());
+        if (type == "NearestStops"s) result.push_back(PrintNearestStops(request_map, rh).AsDict());
     }
 
     json::Print(json::Document{ result }, std::cout);
@@ -59,9 +65,10 @@ void JsonReader::FillCatalogue(transport::Catalogue& catalogue) {
         const auto& type = request_bus_map.at("type"s).AsString();
         if (type == "Bus"s) {
             auto [bus_number, stops, circular_route] = FillRoute(request_bus_map, catalogue);
-            catalogue.AddRoute(bus_number, stops, circular_route);
+            catalogue.AddRoute(bus_number, std::move(stops), circular_route);
         }
     }
+    catalogue.Finalize();
 }
 
 std::tuple<std::string_view, geo::Coordinates, std::map<std::string_view, int>> JsonReader::FillStop(const json::Dict& request_map) const {
@@ -151,9 +158,61 @@ renderer::MapRenderer JsonReader::FillRenderSettings(const json::Node& settings)
     return render_settings;
 }
 
-transport::Router JsonReader::FillRoutingSettings(const json::Node& settings) const {
-    //transport::Router routing_settings;
-    return transport::Router{ settings.AsDict().at("bus_wait_time"s).AsInt(), settings.AsDict().at("bus_velocity"s).AsDouble() };
+transport::RoutingSettings JsonReader::FillRoutingSettings(const json::Node& settings) const {
+    const json::Dict& request_map = settings.AsDict();
+    transport::RoutingSettings routing_settings;
+    routing_settings.bus_wait_time = request_map.at("bus_wait_time"s).AsInt();
+    routing_settings.bus_velocity = request_map.at("bus_velocity"s).AsDouble();
+
+    if (request_map.count("router_engine"s)) {
+        const std::string& engine = request_map.at("router_engine"s).AsString();
+        if (engine == "precomputed"s) routing_settings.engine = transport::RouterEngine::PRECOMPUTED;
+        else if (engine == "dijkstra"s) routing_settings.engine = transport::RouterEngine::DIJKSTRA;
+        else if (engine == "contraction_hierarchies"s) routing_settings.engine = transport::RouterEngine::CONTRACTION_HIERARCHIES;
+        else if (engine == "raptor"s) routing_settings.engine = transport::RouterEngine::RAPTOR;
+        else if (engine == "auto"s) routing_settings.engine = transport::RouterEngine::AUTO;
+        else throw std::logic_error("wrong router_engine"s);
+    }
+    if (request_map.count("graph_model"s)) {
+        const std::string& graph_model = request_map.at("graph_model"s).AsString();
+        if (graph_model == "all_pairs"s) routing_settings.graph_model = transport::GraphModel::ALL_PAIRS;
+        else if (graph_model == "linear"s) routing_settings.graph_model = transport::GraphModel::LINEAR;
+        else throw std::logic_error("wrong graph_model"s);
+    }
+    if (request_map.count("thread_count"s)) {
+        const int thread_count = request_map.at("thread_count"s).AsInt();
+        if (thread_count < 0) throw std::logic_error("wrong thread_count"s);
+        routing_settings.thread_count = static_cast<size_t>(thread_count);
+    }
+    if (request_map.count("search_heuristic"s)) {
+        const std::string& search_heuristic = request_map.at("search_heuristic"s).AsString();
+        if (search_heuristic == "none"s) routing_settings.search_heuristic = transport::SearchHeuristic::NONE;
+        else if (search_heuristic == "astar"s) routing_settings.search_heuristic = transport::SearchHeuristic::A_STAR;
+        else if (search_heuristic == "alt"s) routing_settings.search_heuristic = transport::SearchHeuristic::ALT;
+        else throw std::logic_error("wrong search_heuristic"s);
+    }
+    if (request_map.count("landmark_count"s)) {
+        const int landmark_count = request_map.at("landmark_count"s).AsInt();
+        if (landmark_count < 0) throw std::logic_error("wrong landmark_count"s);
+        routing_settings.landmark_count = static_cast<size_t>(landmark_count);
+    }
+    if (request_map.count("memory_budget"s)) {
+        const double memory_budget = request_map.at("memory_budget"s).AsDouble();
+        if (memory_budget < 0.0) throw std::logic_error("wrong memory_budget"s);
+        routing_settings.memory_budget = static_cast<size_t>(memory_budget * 1024.0 * 1024.0);
+    }
+    if (request_map.count("expected_queries"s)) {
+        const int expected_queries = request_map.at("expected_queries"s).AsInt();
+        if (expected_queries < 0) throw std::logic_error("wrong expected_queries"s);
+        routing_settings.expected_queries = static_cast<size_t>(expected_queries);
+    }
+    if (request_map.count("route_cache_size"s)) {
+        const int route_cache_size = request_map.at("route_cache_size"s).AsInt();
+        if (route_cache_size < 0) throw std::logic_error("wrong route_cache_size"s);
+        routing_settings.route_cache_size = static_cast<size_t>(route_cache_size);
+    }
+
+    return routing_settings;
 }
 
 const json::Node JsonReader::PrintRoute(const json::Dict& request_map, RequestHandler& rh) const {
@@ -199,8 +258,8 @@ const json::Node JsonReader::PrintStop(const json::Dict& request_map, RequestHan
     }
     else {
         json::Array buses;
-        for (const auto& bus : rh.GetBusesByStop(stop_name)) {
-            buses.push_back(bus);
+        for (const std::string_view bus : rh.GetBusesByStop(stop_name)) {
+            buses.push_back(std::string(bus));
         }
         result = json::Builder{}
             .StartDict()
@@ -246,39 +305,33 @@ const json::Node JsonReader::PrintRouting(const json::Dict& request_map, Request
     }
     else {
         json::Array items;
-        double total_time = 0.0;
-        items.reserve(routing.value().edges.size());
-        for (auto& edge_id : routing.value().edges) {
-            const graph::Edge<double> edge = rh.GetRouterGraph().GetEdge(edge_id);
-            if (edge.quality == 0) {
+        items.reserve(routing.value().items.size());
+        for (const auto& item : routing.value().items) {
+            if (item.type == transport::RouteItem::Type::WAIT) {
                 items.emplace_back(json::Node(json::Builder{}
                     .StartDict()
-                        .Key("stop_name"s).Value(edge.name)
-                        .Key("time"s).Value(edge.weight)
+                        .Key("stop_name"s).Value(std::string(rh.GetRouterEdgeName(item.name_id)))
+                        .Key("time"s).Value(item.time)
                         .Key("type"s).Value("Wait"s)
                     .EndDict()
                 .Build()));
-
-                total_time += edge.weight;
             }
             else {
                 items.emplace_back(json::Node(json::Builder{}
                     .StartDict()
-                        .Key("bus"s).Value(edge.name)
-                        .Key("span_count"s).Value(static_cast<int>(edge.quality))
-                        .Key("time"s).Value(edge.weight)
+                        .Key("bus"s).Value(std::string(rh.GetRouterEdgeName(item.name_id)))
+                        .Key("span_count"s).Value(static_cast<int>(item.span_count))
+                        .Key("time"s).Value(item.time)
                         .Key("type"s).Value("Bus"s)
                     .EndDict()
                 .Build()));
-
-                total_time += edge.weight;
             }
         }
 
         result = json::Builder{}
             .StartDict()
                 .Key("request_id"s).Value(id)
-                .Key("total_time"s).Value(total_time)
+                .Key("total_time"s).Value(routing.value().total_time)
                 .Key("items"s).Value(items)
             .EndDict()
         .Build();
@@ -286,3 +339,106 @@ const json::Node JsonReader::PrintRouting(const json::Dict& request_map, Request
 
     return result;
 }
+
+const json::Node JsonReader::PrintRouteMatrix(const json::Dict& request_map, RequestHandler& rh) const {
+    const int id = request_map.at("id"s).AsInt();
+    const auto to_stop_names = [](const json::Node& stops) {
+        std::vector<std::string_view> stop_names;
+        stop_names.reserve(stops.AsArray().size());
+        for (const auto& stop : stops.AsArray()) {
+            stop_names.push_back(stop.AsString());
+        }
+        return stop_names;
+    };
+    const auto matrix = rh.GetRouteMatrix(to_stop_names(request_map.at("from"s)), to_stop_names(request_map.at("to"s)));
+    if (!matrix) {
+        return json::Builder{}
+            .StartDict()
+                .Key("request_id"s).Value(id)
+                .Key("error_message"s).Value("not found"s)
+            .EndDict()
+        .Build();
+    }
+
+    json::Array rows;
+    rows.reserve(matrix->size());
+    for (const auto& matrix_row : *matrix) {
+        json::Array row;
+        row.reserve(matrix_row.size());
+        for (const auto& total_time : matrix_row) {
+            if (total_time) {
+                row.emplace_back(*total_time);
+            }
+            else {
+                row.emplace_back(nullptr);
+            }
+        }
+        rows.emplace_back(std::move(row));
+    }
+
+    return json::Builder{}
+        .StartDict()
+            .Key("request_id"s).Value(id)
+            .Key("matrix"s).Value(rows)
+        .EndDict()
+    .Build();
+}
+
+const json::Node JsonReader::PrintIsochrone(const json::Dict& request_map, RequestHandler& rh) const {
+    const int id = request_map.at("id"s).AsInt();
+    const std::string_view stop_from = request_map.at("from"s).AsString();
+    const double max_time = request_map.at("max_time"s).AsDouble();
+    const auto reachable_stops = rh.GetReachableStops(stop_from, max_time);
+    if (!reachable_stops) {
+        return json::Builder{}
+            .StartDict()
+                .Key("request_id"s).Value(id)
+                .Key("error_message"s).Value("not found"s)
+            .EndDict()
+        .Build();
+    }
+
+    json::Array stops;
+    for (const auto& [name_id, time] : *reachable_stops) {
+        stops.emplace_back(json::Node(json::Builder{}
+            .StartDict()
+                .Key("stop_name"s).Value(std::string(rh.GetRouterEdgeName(name_id)))
+                .Key("time"s).Value(time)
+            .EndDict()
+        .Build()));
+    }
+
+    return json::Builder{}
+        .StartDict()
+            .Key("request_id"s).Value(id)
+            .Key("stops"s).Value(stops)
+        .EndDict()
+    .Build();
+}
+
+// Без count и radius возвращается одна ближайшая остановка, с одним radius - все остановки в радиусе
+const json::Node JsonReader::PrintNearestStops(const json::Dict& request_map, RequestHandler& rh) const {
+    const int id = request_map.at("id"s).AsInt();
+    const geo::Coordinates center = { request_map.at("lat"s).AsDouble(), request_map.at("lng"s).AsDouble() };
+    const bool has_radius = request_map.count("radius"s) > 0;
+    const size_t count = request_map.count("count"s) ? static_cast<size_t>(std::max(request_map.at("count"s).AsInt(), 0))
+        : (has_radius ? std::numeric_limits<size_t>::max() : 1);
+    const double radius = has_radius ? request_map.at("radius"s).AsDouble() : std::numeric_limits<double>::infinity();
+
+    json::Array stops;
+    for (const auto& [stop, distance] : rh.GetNearestStops(center, count, radius)) {
+        stops.emplace_back(json::Node(json::Builder{}
+            .StartDict()
+                .Key("stop_name"s).Value(std::string(stop->name))
+                .Key("distance"s).Value(distance)
+            .EndDict()
+        .Build()));
+    }
+
+    return json::Builder{}
+        .StartDict()
+            .Key("request_id"s).Value(id)
+            .Key("stops"s).Value(stops)
+        .EndDict()
+    .Build();
+}
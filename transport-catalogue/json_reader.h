@@ -23,12 +23,15 @@ public:
 
     void FillCatalogue(transport::Catalogue& catalogue);
     renderer::MapRenderer FillRenderSettings(const json::Node& settings) const;
-    transport::Router FillRoutingSettings(const json::Node& settings) const;
+    transport::RoutingSettings FillRoutingSettings(const json::Node& settings) const;
 
     const json::Node PrintRoute(const json::Dict& request_map, RequestHandler& rh) const;
     const json::Node PrintStop(const json::Dict& request_map, RequestHandler& rh) const;
     const json::Node PrintMap(const json::Dict& request_map, RequestHandler& rh) const;
     const json::Node PrintRouting(const json::Dict& request_map, RequestHandler& rh) const;
+    const json::Node PrintRouteMatrix(const json::Dict& request_map, RequestHandler& rh) const;
+    const json::Node PrintIsochrone(const json::Dict& request_map, RequestHandler& rh) const;
+    const json::Node PrintNearestStops(const json::Dict& request_map, RequestHandler& rh) const;
 
 private:
     json::Document input_;
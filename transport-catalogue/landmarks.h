@@ -0,0 +1,192 @@
+#pragma once
+
+#include "graph.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Нижние оценки весов путей по методу ALT (A*, ориентиры, неравенство треугольника).
+// Для каждого ориентира L хранятся веса путей L -> v и v -> L до всех вершин, тогда
+// w(v, t) >= max(w(L, t) - w(L, v), w(v, L) - w(t, L)). Ориентиры выбираются
+// жадно: каждый следующий - вершина, наиболее удалённая от уже выбранных.
+template <typename Weight>
+class Landmarks {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    // Таблицы весов построчно, landmark_count x V; недостижимые вершины имеют вес GetUnreachableWeight
+    struct LandmarkData {
+        std::vector<VertexId> vertices;
+        std::vector<Weight> from_weights;
+        std::vector<Weight> to_weights;
+    };
+
+    Landmarks(const Graph& graph, size_t landmark_count);
+    // Принимает готовые таблицы, не пересчитывая их
+    Landmarks(const Graph& graph, LandmarkData landmark_data);
+
+    // Нижняя оценка веса пути из from в to; вес недостижимости, если пути точно нет
+    Weight GetLowerBound(VertexId from, VertexId to) const;
+    const LandmarkData& GetLandmarkData() const;
+
+private:
+    static constexpr Weight ZERO_WEIGHT{};
+    static constexpr Weight UNREACHABLE_WEIGHT = GetUnreachableWeight<Weight>();
+
+    // Веса путей от source до всех вершин; при reverse - от всех вершин до source
+    std::vector<Weight> ComputeWeights(const Graph& graph, VertexId source, bool reverse) const;
+
+    size_t vertex_count_;
+    LandmarkData landmark_data_;
+    // Входящие рёбра в формате CSR для обратного поиска: (начало ребра, вес)
+    std::vector<size_t> in_offsets_;
+    std::vector<std::pair<VertexId, Weight>> in_arcs_;
+};
+
+template <typename Weight>
+Landmarks<Weight>::Landmarks(const Graph& graph, size_t landmark_count)
+    : vertex_count_(graph.GetVertexCount())
+{
+    landmark_count = std::min(landmark_count, vertex_count_);
+    if (landmark_count == 0) {
+        return;
+    }
+    in_offsets_.assign(vertex_count_ + 1, 0);
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        for (const auto& arc : graph.GetArcs(vertex)) {
+            if (arc.weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+            ++in_offsets_[arc.to + 1];
+        }
+    }
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        in_offsets_[vertex + 1] += in_offsets_[vertex];
+    }
+    in_arcs_.resize(in_offsets_.back());
+    std::vector<size_t> positions(in_offsets_.begin(), in_offsets_.end() - 1);
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        for (const auto& arc : graph.GetArcs(vertex)) {
+            in_arcs_[positions[arc.to]++] = { vertex, arc.weight };
+        }
+    }
+
+    // Удалённость вершины от выбранных ориентиров; недостижимость считается очень большим весом,
+    // чтобы ориентиры попадали и в несвязанные части графа
+    const Weight far_weight = std::numeric_limits<Weight>::max() / 4;
+    const auto finite = [far_weight](Weight weight) { return weight == UNREACHABLE_WEIGHT ? far_weight : weight; };
+    std::vector<Weight> remoteness(vertex_count_, UNREACHABLE_WEIGHT);
+
+    // Первый ориентир - самая удалённая от вершины 0 вершина
+    const std::vector<Weight> start_weights = ComputeWeights(graph, 0, false);
+    VertexId landmark = 0;
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        if (start_weights[vertex] != UNREACHABLE_WEIGHT && start_weights[vertex] > start_weights[landmark]) {
+            landmark = vertex;
+        }
+    }
+
+    landmark_data_.from_weights.reserve(landmark_count * vertex_count_);
+    landmark_data_.to_weights.reserve(landmark_count * vertex_count_);
+    while (landmark_data_.vertices.size() < landmark_count) {
+        const std::vector<Weight> from_weights = ComputeWeights(graph, landmark, false);
+        const std::vector<Weight> to_weights = ComputeWeights(graph, landmark, true);
+        landmark_data_.vertices.push_back(landmark);
+        landmark_data_.from_weights.insert(landmark_data_.from_weights.end(), from_weights.begin(), from_weights.end());
+        landmark_data_.to_weights.insert(landmark_data_.to_weights.end(), to_weights.begin(), to_weights.end());
+
+        for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+            remoteness[vertex] = std::min(remoteness[vertex], finite(from_weights[vertex]) + finite(to_weights[vertex]));
+        }
+        landmark = static_cast<VertexId>(std::max_element(remoteness.begin(), remoteness.end()) - remoteness.begin());
+        if (!(remoteness[landmark] > ZERO_WEIGHT)) {
+            break;
+        }
+    }
+    // Обратные рёбра нужны только при построении
+    std::vector<size_t>().swap(in_offsets_);
+    std::vector<std::pair<VertexId, Weight>>().swap(in_arcs_);
+}
+
+template <typename Weight>
+Landmarks<Weight>::Landmarks(const Graph& graph, LandmarkData landmark_data)
+    : vertex_count_(graph.GetVertexCount())
+    , landmark_data_(std::move(landmark_data))
+{
+    const size_t table_size = landmark_data_.vertices.size() * vertex_count_;
+    if (landmark_data_.from_weights.size() != table_size || landmark_data_.to_weights.size() != table_size) {
+        throw std::invalid_argument("Landmarks don't match the graph");
+    }
+}
+
+template <typename Weight>
+const typename Landmarks<Weight>::LandmarkData& Landmarks<Weight>::GetLandmarkData() const {
+    return landmark_data_;
+}
+
+template <typename Weight>
+Weight Landmarks<Weight>::GetLowerBound(VertexId from, VertexId to) const {
+    Weight bound = ZERO_WEIGHT;
+    for (size_t row = 0; row < landmark_data_.from_weights.size(); row += vertex_count_) {
+        const Weight landmark_to_from = landmark_data_.from_weights[row + from];
+        const Weight landmark_to_to = landmark_data_.from_weights[row + to];
+        if (landmark_to_from != UNREACHABLE_WEIGHT) {
+            if (landmark_to_to == UNREACHABLE_WEIGHT) {
+                return UNREACHABLE_WEIGHT;
+            }
+            bound = std::max(bound, landmark_to_to - landmark_to_from);
+        }
+        const Weight from_to_landmark = landmark_data_.to_weights[row + from];
+        const Weight to_to_landmark = landmark_data_.to_weights[row + to];
+        if (to_to_landmark != UNREACHABLE_WEIGHT) {
+            if (from_to_landmark == UNREACHABLE_WEIGHT) {
+                return UNREACHABLE_WEIGHT;
+            }
+            bound = std::max(bound, from_to_landmark - to_to_landmark);
+        }
+    }
+    return bound;
+}
+
+template <typename Weight>
+std::vector<Weight> Landmarks<Weight>::ComputeWeights(const Graph& graph, VertexId source, bool reverse) const {
+    using QueueItem = std::pair<Weight, VertexId>;
+    std::vector<Weight> weights(vertex_count_, UNREACHABLE_WEIGHT);
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+    weights[source] = ZERO_WEIGHT;
+    queue.emplace(ZERO_WEIGHT, source);
+    while (!queue.empty()) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (weight > weights[vertex]) {
+            continue;
+        }
+        const auto relax = [&](VertexId next, Weight edge_weight) {
+            if (weight + edge_weight < weights[next]) {
+                weights[next] = weight + edge_weight;
+                queue.emplace(weights[next], next);
+            }
+        };
+        if (reverse) {
+            for (size_t i = in_offsets_[vertex]; i < in_offsets_[vertex + 1]; ++i) {
+                relax(in_arcs_[i].first, in_arcs_[i].second);
+            }
+        }
+        else {
+            for (const auto& arc : graph.GetArcs(vertex)) {
+                relax(arc.to, arc.weight);
+            }
+        }
+    }
+    return weights;
+}
+
+}  // namespace graph
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdlib>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace cache {
+
+struct CacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+};
+
+// Ограниченный по размеру кэш, вытесняющий давно не использованные элементы.
+// Все операции защищены мьютексом, поэтому кэш можно использовать из разных потоков.
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache {
+public:
+    explicit LruCache(size_t capacity)
+        : capacity_(capacity) {
+        index_.reserve(capacity);
+    }
+
+    // Возвращает копию значения и делает элемент самым свежим
+    std::optional<Value> Get(const Key& key) {
+        std::lock_guard lock(mutex_);
+        const auto it = index_.find(key);
+        if (it == index_.end()) {
+            ++stats_.misses;
+            return std::nullopt;
+        }
+        ++stats_.hits;
+        items_.splice(items_.begin(), items_, it->second);
+        return it->second->second;
+    }
+
+    void Put(const Key& key, Value value) {
+        if (capacity_ == 0) {
+            return;
+        }
+        std::lock_guard lock(mutex_);
+        if (const auto it = index_.find(key); it != index_.end()) {
+            it->second->second = std::move(value);
+            items_.splice(items_.begin(), items_, it->second);
+            return;
+        }
+        if (items_.size() == capacity_) {
+            index_.erase(items_.back().first);
+            items_.pop_back();
+        }
+        items_.emplace_front(key, std::move(value));
+        index_.emplace(key, items_.begin());
+    }
+
+    CacheStats GetStats() const {
+        std::lock_guard lock(mutex_);
+        return stats_;
+    }
+
+    size_t GetCapacity() const {
+        return capacity_;
+    }
+
+private:
+    using Items = std::list<std::pair<Key, Value>>;
+
+    const size_t capacity_;
+    mutable std::mutex mutex_;
+    // Элементы от самого свежего к самому старому
+    Items items_;
+    std::unordered_map<Key, typename Items::iterator, Hash> index_;
+    CacheStats stats_;
+};
+
+} // namespace cache
@@ -1,6 +1,7 @@
 #include <fstream>
 #include <iostream>
 #include <string_view>
+#include <utility>
 
 #include "transport_catalogue.h"
 #include "json_reader.h"
@@ -40,12 +41,16 @@ int main(int argc, char* argv[]) {
         JsonReader json_input(std::cin);
         std::ifstream db_file(json_input.GetSerializationSettings().AsDict().at("file"s).AsString(), std::ios::binary);
         if (db_file) {
-            auto [catalogue, renderer, router, graph, stop_ids] = serialization::Deserialize(db_file);
+            auto [catalogue, renderer, router, graph, stop_count] = serialization::Deserialize(db_file);
             const auto& stat_requests = json_input.GetStatRequests();
-            router.SetGraph(graph, stop_ids);
+            router.SetGraph(std::move(graph), stop_count);
             RequestHandler rh = { catalogue, renderer, router };
             
             json_input.ProcessRequests(stat_requests, rh);
+            if (router.GetRoutingSettings().route_cache_size > 0) {
+                const auto cache_stats = rh.GetRouteCacheStats();
+                std::cerr << "Route cache: "sv << cache_stats.hits << " hits, "sv << cache_stats.misses << " misses\n"sv;
+            }
         }
     }
     else {
@@ -44,7 +44,7 @@ std::vector<svg::Text> MapRenderer::GetBusLabel(const std::map<std::string_view,
         text.SetFontSize(render_settings_.bus_label_font_size);
         text.SetFontFamily("Verdana");
         text.SetFontWeight("bold");
-        text.SetData(bus->number);
+        text.SetData(std::string(bus->number));
         text.SetFillColor(render_settings_.color_palette[color_num]);
         if (color_num < (render_settings_.color_palette.size() - 1)) ++color_num;
         else color_num = 0;
@@ -54,7 +54,7 @@ std::vector<svg::Text> MapRenderer::GetBusLabel(const std::map<std::string_view,
         underlayer.SetFontSize(render_settings_.bus_label_font_size);
         underlayer.SetFontFamily("Verdana");
         underlayer.SetFontWeight("bold");
-        underlayer.SetData(bus->number);
+        underlayer.SetData(std::string(bus->number));
         underlayer.SetFillColor(render_settings_.underlayer_color);
         underlayer.SetStrokeColor(render_settings_.underlayer_color);
         underlayer.SetStrokeWidth(render_settings_.underlayer_width);
@@ -101,14 +101,14 @@ std::vector<svg::Text> MapRenderer::GetStopsLabels(const std::map<std::string_vi
         text.SetOffset(render_settings_.stop_label_offset);
         text.SetFontSize(render_settings_.stop_label_font_size);
         text.SetFontFamily("Verdana");
-        text.SetData(stop->name);
+        text.SetData(std::string(stop->name));
         text.SetFillColor("black");
 
         underlayer.SetPosition(sp(stop->coordinates));
         underlayer.SetOffset(render_settings_.stop_label_offset);
         underlayer.SetFontSize(render_settings_.stop_label_font_size);
         underlayer.SetFontFamily("Verdana");
-        underlayer.SetData(stop->name);
+        underlayer.SetData(std::string(stop->name));
         underlayer.SetFillColor(render_settings_.underlayer_color);
         underlayer.SetStrokeColor(render_settings_.underlayer_color);
         underlayer.SetStrokeWidth(render_settings_.underlayer_width);
@@ -144,7 +144,7 @@ svg::Document MapRenderer::GetSVG(const std::map<std::string_view, const transpo
     return result;
 }
 
-const RenderSettings MapRenderer::GetRenderSettings() const {
+const RenderSettings& MapRenderer::GetRenderSettings() const {
     return render_settings_;
 }
 
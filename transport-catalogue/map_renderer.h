@@ -6,6 +6,7 @@
 #include "domain.h"
 
 #include <algorithm>
+#include <utility>
 
 namespace renderer {
 
@@ -100,8 +101,8 @@ class MapRenderer {
 public:
     MapRenderer() {}
 
-    MapRenderer(const RenderSettings& render_settings)
-        : render_settings_(render_settings)
+    MapRenderer(RenderSettings render_settings)
+        : render_settings_(std::move(render_settings))
     {}
 
     std::vector<svg::Polyline> GetRouteLines(const std::map<std::string_view, const transport::Bus*>& buses, const SphereProjector& sp) const;
@@ -111,10 +112,10 @@ public:
 
     svg::Document GetSVG(const std::map<std::string_view, const transport::Bus*>& buses) const;
 
-    const RenderSettings GetRenderSettings() const;
+    const RenderSettings& GetRenderSettings() const;
 
 private:
-    const RenderSettings render_settings_;
+    RenderSettings render_settings_;
 };
 
 } // namespace renderer
@@ -0,0 +1,56 @@
+#include "name_arena.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace transport {
+
+uint32_t NameArena::Intern(std::string_view name) {
+    if (const auto it = name_ids_.find(name); it != name_ids_.end()) {
+        return it->second;
+    }
+    const std::string_view stored = Store(name);
+    const uint32_t name_id = static_cast<uint32_t>(names_.size());
+    names_.push_back(stored);
+    name_ids_.emplace(stored, name_id);
+    return name_id;
+}
+
+std::optional<uint32_t> NameArena::Find(std::string_view name) const {
+    if (const auto it = name_ids_.find(name); it != name_ids_.end()) {
+        return it->second;
+    }
+    return std::nullopt;
+}
+
+std::string_view NameArena::Get(uint32_t name_id) const {
+    return names_.at(name_id);
+}
+
+size_t NameArena::Size() const {
+    return names_.size();
+}
+
+// Строка длиннее блока получает отдельный блок, остаток текущего блока при этом не теряется
+std::string_view NameArena::Store(std::string_view name) {
+    if (name.empty()) {
+        return {};
+    }
+    if (name.size() > BLOCK_SIZE) {
+        blocks_.push_back(std::make_unique<char[]>(name.size()));
+        std::memcpy(blocks_.back().get(), name.data(), name.size());
+        return { blocks_.back().get(), name.size() };
+    }
+    if (name.size() > block_free_) {
+        blocks_.push_back(std::make_unique<char[]>(BLOCK_SIZE));
+        block_end_ = blocks_.back().get();
+        block_free_ = BLOCK_SIZE;
+    }
+    char* data = block_end_;
+    std::memcpy(data, name.data(), name.size());
+    block_end_ += name.size();
+    block_free_ -= name.size();
+    return { data, name.size() };
+}
+
+} // namespace transport
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace transport {
+
+// Хранилище названий остановок и номеров автобусов: каждая строка хранится один раз в блоках,
+// которые не перемещаются, поэтому выданные string_view действительны всё время жизни хранилища,
+// в том числе после его перемещения. Строки нумеруются подряд в порядке первого добавления
+class NameArena {
+public:
+    NameArena() = default;
+    NameArena(const NameArena&) = delete;
+    NameArena& operator=(const NameArena&) = delete;
+    NameArena(NameArena&&) = default;
+    NameArena& operator=(NameArena&&) = default;
+
+    // Номер строки; строка копируется в хранилище только при первом добавлении
+    uint32_t Intern(std::string_view name);
+    std::optional<uint32_t> Find(std::string_view name) const;
+    std::string_view Get(uint32_t name_id) const;
+    size_t Size() const;
+
+private:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    std::string_view Store(std::string_view name);
+
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    size_t block_free_ = 0;
+    char* block_end_ = nullptr;
+    std::vector<std::string_view> names_;
+    std::unordered_map<std::string_view, uint32_t> name_ids_;
+};
+
+} // namespace transport
@@ -0,0 +1,191 @@
+#include "raptor_router.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace transport {
+
+RaptorRouter::RaptorRouter(RaptorData raptor_data, double bus_wait_time, double meters_per_minute)
+    : raptor_data_(std::move(raptor_data))
+    , bus_wait_time_(bus_wait_time)
+    , meters_per_minute_(meters_per_minute)
+{
+    const size_t stop_count = raptor_data_.stop_count;
+    const auto& routes = raptor_data_.routes;
+    stop_routes_offsets_.assign(stop_count + 1, 0);
+    for (const RaptorRoute& route : routes) {
+        if (route.stops.size() != route.distances.size()) {
+            throw std::invalid_argument("Raptor data is inconsistent");
+        }
+        for (const uint32_t stop : route.stops) {
+            if (stop >= stop_count) {
+                throw std::invalid_argument("Raptor data is inconsistent");
+            }
+            ++stop_routes_offsets_[stop + 1];
+        }
+    }
+    for (size_t stop = 0; stop < stop_count; ++stop) {
+        stop_routes_offsets_[stop + 1] += stop_routes_offsets_[stop];
+    }
+    stop_routes_.resize(stop_routes_offsets_.back());
+    std::vector<size_t> positions(stop_routes_offsets_.begin(), stop_routes_offsets_.end() - 1);
+    for (uint32_t route_index = 0; route_index < routes.size(); ++route_index) {
+        const auto& stops = routes[route_index].stops;
+        for (uint32_t position = 0; position < stops.size(); ++position) {
+            stop_routes_[positions[stops[position]]++] = { route_index, position };
+        }
+    }
+
+    round_labels_.emplace_back(stop_count);
+    round_touched_stops_.emplace_back();
+    best_arrivals_.assign(stop_count, UNREACHABLE_TIME);
+    marked_.assign(stop_count, false);
+    route_first_positions_.assign(routes.size(), NO_POSITION);
+}
+
+const RaptorData& RaptorRouter::GetRaptorData() const {
+    return raptor_data_;
+}
+
+double RaptorRouter::ComputeRideTime(const RaptorRoute& route, uint32_t from_position, uint32_t to_position) const {
+    return static_cast<double>(route.distances[to_position] - route.distances[from_position]) / meters_per_minute_;
+}
+
+std::optional<RouteInfo> RaptorRouter::BuildRoute(uint32_t from, uint32_t to) const {
+    if (from >= raptor_data_.stop_count || to >= raptor_data_.stop_count) {
+        throw std::out_of_range("Stop is out of range");
+    }
+    Search(from, to);
+    if (best_arrivals_[to] == UNREACHABLE_TIME) {
+        return std::nullopt;
+    }
+
+    // Метки улучшаются строго, поэтому лучшее время впервые достигается в раунде с наименьшим числом посадок
+    size_t round = 0;
+    while (round_labels_[round][to].arrival != best_arrivals_[to]) {
+        ++round;
+    }
+
+    RouteInfo route_info;
+    for (uint32_t stop = to; round > 0; --round) {
+        const Label& label = round_labels_[round][stop];
+        const RaptorRoute& route = raptor_data_.routes[label.route];
+        const uint32_t board_stop = route.stops[label.board_position];
+        route_info.items.push_back({ RouteItem::Type::BUS, route.name_id, label.alight_position - label.board_position,
+                                     ComputeRideTime(route, label.board_position, label.alight_position) });
+        route_info.items.push_back({ RouteItem::Type::WAIT, board_stop, 0, bus_wait_time_ });
+        stop = board_stop;
+    }
+    std::reverse(route_info.items.begin(), route_info.items.end());
+    for (const RouteItem& item : route_info.items) {
+        route_info.total_time += item.time;
+    }
+    return route_info;
+}
+
+std::vector<std::optional<double>> RaptorRouter::BuildTimes(uint32_t from) const {
+    if (from >= raptor_data_.stop_count) {
+        throw std::out_of_range("Stop is out of range");
+    }
+    Search(from, NO_STOP);
+    std::vector<std::optional<double>> times(raptor_data_.stop_count);
+    for (const uint32_t stop : best_touched_stops_) {
+        times[stop] = best_arrivals_[stop];
+    }
+    return times;
+}
+
+void RaptorRouter::Search(uint32_t from, uint32_t to) const {
+    ResetSearch();
+    round_count_ = 1;
+    SetLabel(0, from, { 0.0, 0, 0, 0 });
+
+    for (size_t round = 1; !marked_stops_.empty(); ++round) {
+        if (round_labels_.size() == round) {
+            round_labels_.emplace_back(raptor_data_.stop_count);
+            round_touched_stops_.emplace_back();
+        }
+        round_count_ = round + 1;
+
+        // В каждом маршруте достаточно начать с первой по ходу движения отмеченной остановки
+        for (const uint32_t stop : marked_stops_) {
+            marked_[stop] = false;
+            for (size_t i = stop_routes_offsets_[stop]; i < stop_routes_offsets_[stop + 1]; ++i) {
+                const auto [route, position] = stop_routes_[i];
+                if (route_first_positions_[route] == NO_POSITION) {
+                    queued_routes_.push_back(route);
+                }
+                route_first_positions_[route] = std::min(route_first_positions_[route], position);
+            }
+        }
+        marked_stops_.clear();
+
+        for (const uint32_t route : queued_routes_) {
+            ScanRoute(route, route_first_positions_[route], round, to);
+            route_first_positions_[route] = NO_POSITION;
+        }
+        queued_routes_.clear();
+    }
+}
+
+// Проезжает маршрут, держа лучшую из возможных посадок: пересесть на остановке выгоднее,
+// чем ехать дальше, если туда можно добраться за предыдущий раунд и ожидание окупается
+void RaptorRouter::ScanRoute(uint32_t route_index, uint32_t first_position, size_t round, uint32_t to) const {
+    const RaptorRoute& route = raptor_data_.routes[route_index];
+    const auto& previous_labels = round_labels_[round - 1];
+    uint32_t board_position = NO_POSITION;
+    double board_time = 0.0;
+
+    for (uint32_t position = first_position; position < route.stops.size(); ++position) {
+        const uint32_t stop = route.stops[position];
+        if (board_position != NO_POSITION) {
+            const double arrival = board_time + ComputeRideTime(route, board_position, position);
+            const double target_arrival = to == NO_STOP ? UNREACHABLE_TIME : best_arrivals_[to];
+            if (arrival < best_arrivals_[stop] && arrival < target_arrival) {
+                SetLabel(round, stop, { arrival, route_index, board_position, position });
+            }
+        }
+        const double previous_arrival = previous_labels[stop].arrival;
+        if (previous_arrival != UNREACHABLE_TIME) {
+            const double candidate_time = previous_arrival + bus_wait_time_;
+            if (board_position == NO_POSITION
+                || candidate_time < board_time + ComputeRideTime(route, board_position, position)) {
+                board_position = position;
+                board_time = candidate_time;
+            }
+        }
+    }
+}
+
+void RaptorRouter::SetLabel(size_t round, uint32_t stop, const Label& label) const {
+    Label& round_label = round_labels_[round][stop];
+    if (round_label.arrival == UNREACHABLE_TIME) {
+        round_touched_stops_[round].push_back(stop);
+    }
+    round_label = label;
+    if (best_arrivals_[stop] == UNREACHABLE_TIME) {
+        best_touched_stops_.push_back(stop);
+    }
+    best_arrivals_[stop] = label.arrival;
+    if (!marked_[stop]) {
+        marked_[stop] = true;
+        marked_stops_.push_back(stop);
+    }
+}
+
+void RaptorRouter::ResetSearch() const {
+    for (size_t round = 0; round < round_count_; ++round) {
+        for (const uint32_t stop : round_touched_stops_[round]) {
+            round_labels_[round][stop] = Label{};
+        }
+        round_touched_stops_[round].clear();
+    }
+    for (const uint32_t stop : best_touched_stops_) {
+        best_arrivals_[stop] = UNREACHABLE_TIME;
+    }
+    best_touched_stops_.clear();
+    round_count_ = 0;
+}
+
+} // namespace transport
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "domain.h"
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace transport {
+
+// Маршрут автобуса в одном направлении: остановки в порядке движения
+// и дорожное расстояние от первой из них до каждой следующей
+struct RaptorRoute {
+    uint32_t name_id;
+    std::vector<uint32_t> stops;
+    std::vector<int> distances;
+};
+
+// Остановки пронумерованы так же, как в таблице имён маршрутизатора
+struct RaptorData {
+    size_t stop_count = 0;
+    std::vector<RaptorRoute> routes;
+};
+
+// Маршрутизатор RAPTOR: поиск идёт раундами прямо по последовательностям остановок автобусов,
+// раунд k находит лучшие маршруты ровно с k посадками. Граф и предрасчёт не нужны.
+// Из маршрутов с одинаковым временем выбирается маршрут с меньшим числом пересадок.
+// Буферы поиска переиспользуются, поэтому один экземпляр нельзя использовать из разных потоков.
+class RaptorRouter {
+public:
+    // meters_per_minute - скорость автобуса, bus_wait_time - время ожидания на каждой посадке
+    RaptorRouter(RaptorData raptor_data, double bus_wait_time, double meters_per_minute);
+
+    std::optional<RouteInfo> BuildRoute(uint32_t from, uint32_t to) const;
+    // Время в пути от from до каждой остановки, nullopt - маршрута нет
+    std::vector<std::optional<double>> BuildTimes(uint32_t from) const;
+    const RaptorData& GetRaptorData() const;
+
+private:
+    static constexpr uint32_t NO_STOP = std::numeric_limits<uint32_t>::max();
+    static constexpr uint32_t NO_POSITION = std::numeric_limits<uint32_t>::max();
+    static constexpr double UNREACHABLE_TIME = std::numeric_limits<double>::infinity();
+
+    // Метка остановки в раунде: время прибытия и поездка, которой оно достигнуто
+    struct Label {
+        double arrival = UNREACHABLE_TIME;
+        uint32_t route = 0;
+        uint32_t board_position = 0;
+        uint32_t alight_position = 0;
+    };
+
+    struct StopRoute {
+        uint32_t route;
+        uint32_t position;
+    };
+
+    double ComputeRideTime(const RaptorRoute& route, uint32_t from_position, uint32_t to_position) const;
+    void Search(uint32_t from, uint32_t to) const;
+    void ScanRoute(uint32_t route_index, uint32_t first_position, size_t round, uint32_t to) const;
+    void SetLabel(size_t round, uint32_t stop, const Label& label) const;
+    void ResetSearch() const;
+
+    RaptorData raptor_data_;
+    double bus_wait_time_;
+    double meters_per_minute_;
+    // Маршруты через каждую остановку в формате CSR
+    std::vector<size_t> stop_routes_offsets_;
+    std::vector<StopRoute> stop_routes_;
+
+    mutable std::vector<std::vector<Label>> round_labels_;
+    mutable std::vector<std::vector<uint32_t>> round_touched_stops_;
+    mutable std::vector<double> best_arrivals_;
+    mutable std::vector<uint32_t> best_touched_stops_;
+    mutable std::vector<bool> marked_;
+    mutable std::vector<uint32_t> marked_stops_;
+    mutable std::vector<uint32_t> route_first_positions_;
+    mutable std::vector<uint32_t> queued_routes_;
+    mutable size_t round_count_ = 0;
+};
+
+} // namespace transport
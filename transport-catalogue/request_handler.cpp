@@ -1,39 +1,12 @@
 #include "request_handler.h"
 
 std::optional<transport::BusStat> RequestHandler::GetBusStat(const std::string_view bus_number) const {
-    transport::BusStat bus_stat{};
     const transport::Bus* bus = catalogue_.FindRoute(bus_number);
-
     if (!bus) throw std::invalid_argument("bus not found");
-    if (bus->is_circle) bus_stat.stops_count = bus->stops.size();
-    else bus_stat.stops_count = bus->stops.size() * 2 - 1;
-
-    int route_length = 0;
-    double geographic_length = 0.0;
-
-    for (size_t i = 0; i < bus->stops.size() - 1; ++i) {
-        auto from = bus->stops[i];
-        auto to = bus->stops[i + 1];
-        if (bus->is_circle) {
-            route_length += catalogue_.GetDistance(from, to);
-            geographic_length += geo::ComputeDistance(from->coordinates,
-                to->coordinates);
-        }
-        else {
-            route_length += catalogue_.GetDistance(from, to) + catalogue_.GetDistance(to, from);
-            geographic_length += geo::ComputeDistance(from->coordinates,
-                to->coordinates) * 2;
-        }
-    }
-
-    bus_stat.unique_stops_count = catalogue_.UniqueStopsCount(bus_number);
-    bus_stat.route_length = route_length;
-    bus_stat.curvature = route_length / geographic_length;
-
-    return bus_stat;
-}
-
-const std::set<std::string> RequestHandler::GetBusesByStop(std::string_view stop_name) const {
+    return bus->stat;
+}
+
+const std::vector<std::string_view>& RequestHandler::GetBusesByStop(std::string_view stop_name) const {
     return catalogue_.FindStop(stop_name)->buses_by_stop;
 }
 
@@ -45,14 +18,36 @@ bool RequestHandler::IsStopName(const std::string_view stop_name) const {
     return catalogue_.FindStop(stop_name);
 }
 
-const std::optional<graph::Router<double>::RouteInfo> RequestHandler::GetOptimalRoute(const std::string_view stop_from, const std::string_view stop_to) const {
+const std::optional<transport::RouteInfo> RequestHandler::GetOptimalRoute(const std::string_view stop_from, const std::string_view stop_to) const {
     return router_.FindRoute(stop_from, stop_to);
 }
 
-const graph::DirectedWeightedGraph<double>& RequestHandler::GetRouterGraph() const {
+const graph::DirectedWeightedGraph<transport::RouteWeight>& RequestHandler::GetRouterGraph() const {
     return router_.GetGraph();
 }
 
+std::optional<std::vector<std::vector<std::optional<double>>>> RequestHandler::GetRouteMatrix(const std::vector<std::string_view>& stops_from,
+    const std::vector<std::string_view>& stops_to) const {
+    return router_.FindRouteMatrix(stops_from, stops_to);
+}
+
+std::optional<std::vector<std::pair<uint32_t, double>>> RequestHandler::GetReachableStops(const std::string_view stop_from, double max_time) const {
+    return router_.FindReachableStops(stop_from, max_time);
+}
+
+std::vector<std::pair<const transport::Stop*, double>> RequestHandler::GetNearestStops(geo::Coordinates center, size_t count,
+    double radius) const {
+    return catalogue_.FindNearestStops(center, count, radius);
+}
+
+cache::CacheStats RequestHandler::GetRouteCacheStats() const {
+    return router_.GetRouteCacheStats();
+}
+
+std::string_view RequestHandler::GetRouterEdgeName(uint32_t name_id) const {
+    return router_.GetName(name_id);
+}
+
 svg::Document RequestHandler::RenderMap() const {
     return renderer_.GetSVG(catalogue_.GetSortedAllBuses());
 }
\ No newline at end of file
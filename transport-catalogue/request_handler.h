@@ -18,11 +18,17 @@ public:
     }
 
     std::optional<transport::BusStat> GetBusStat(const std::string_view bus_number) const;
-    const std::set<std::string> GetBusesByStop(std::string_view stop_name) const;
+    const std::vector<std::string_view>& GetBusesByStop(std::string_view stop_name) const;
     bool IsBusNumber(const std::string_view bus_number) const;
     bool IsStopName(const std::string_view stop_name) const;
-    const std::optional<graph::Router<double>::RouteInfo> GetOptimalRoute(const std::string_view stop_from, const std::string_view stop_to) const;
-    const graph::DirectedWeightedGraph<double>& GetRouterGraph() const;
+    const std::optional<transport::RouteInfo> GetOptimalRoute(const std::string_view stop_from, const std::string_view stop_to) const;
+    std::optional<std::vector<std::vector<std::optional<double>>>> GetRouteMatrix(const std::vector<std::string_view>& stops_from,
+        const std::vector<std::string_view>& stops_to) const;
+    std::optional<std::vector<std::pair<uint32_t, double>>> GetReachableStops(const std::string_view stop_from, double max_time) const;
+    std::vector<std::pair<const transport::Stop*, double>> GetNearestStops(geo::Coordinates center, size_t count, double radius) const;
+    const graph::DirectedWeightedGraph<transport::RouteWeight>& GetRouterGraph() const;
+    std::string_view GetRouterEdgeName(uint32_t name_id) const;
+    cache::CacheStats GetRouteCacheStats() const;
 
     svg::Document RenderMap() const;
 
@@ -1,11 +1,13 @@
 #pragma once
 
 #include "graph.h"
+#include "thread_pool.h"
 
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <iterator>
+#include <limits>
 #include <optional>
 #include <stdexcept>
 #include <unordered_map>
@@ -20,98 +22,238 @@ private:
     using Graph = DirectedWeightedGraph<Weight>;
 
 public:
-    explicit Router(const Graph& graph);
-
     struct RouteInfo {
         Weight weight;
         std::vector<EdgeId> edges;
     };
 
+    // Таблица маршрутов в плоском виде (построчно, V x V).
+    // В prev_edges хранится последнее ребро маршрута, NO_EDGE для маршрута из вершины
+    // в саму себя и NO_ROUTE, если маршрута нет; вес такой ячейки не используется.
+    struct RoutesTable {
+        std::vector<Weight> weights;
+        std::vector<uint32_t> prev_edges;
+    };
+    static constexpr uint32_t NO_ROUTE = std::numeric_limits<uint32_t>::max();
+    static constexpr uint32_t NO_EDGE = NO_ROUTE - 1;
+
+    explicit Router(const Graph& graph);
+    // Блочный вариант предрасчёта: независимые блоки таблицы обрабатываются в пуле потоков
+    Router(const Graph& graph, parallel::ThreadPool& thread_pool);
+    // Принимает готовую таблицу маршрутов, не пересчитывая её
+    Router(const Graph& graph, RoutesTable routes_table);
+
     std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+    // Матрица весов кратчайших путей: строка на каждую вершину из sources,
+    // nullopt - маршрута нет
+    std::vector<std::vector<std::optional<Weight>>> BuildWeightMatrix(const std::vector<VertexId>& sources,
+        const std::vector<VertexId>& targets) const;
+    const RoutesTable& GetRoutesTable() const;
 
 private:
-    struct RouteInternalData {
-        Weight weight;
-        std::optional<EdgeId> prev_edge;
-    };
-    using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
+    // Недостижимые ячейки хранят вес недостижимости, поэтому при релаксации
+    // их не нужно проверять отдельно
+    static constexpr Weight UNREACHABLE_WEIGHT = GetUnreachableWeight<Weight>();
 
     void InitializeRoutesInternalData(const Graph& graph) {
         const size_t vertex_count = graph.GetVertexCount();
         for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
-            routes_internal_data_[vertex][vertex] = RouteInternalData{ ZERO_WEIGHT, std::nullopt };
-            for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
-                const auto& edge = graph.GetEdge(edge_id);
-                if (edge.weight < ZERO_WEIGHT) {
+            const size_t row = vertex * vertex_count;
+            routes_internal_data_.weights[row + vertex] = ZERO_WEIGHT;
+            routes_internal_data_.prev_edges[row + vertex] = NO_EDGE;
+            for (const auto& arc : graph.GetArcs(vertex)) {
+                if (arc.weight < ZERO_WEIGHT) {
                     throw std::domain_error("Edges' weights should be non-negative");
                 }
-                auto& route_internal_data = routes_internal_data_[vertex][edge.to];
-                if (!route_internal_data || route_internal_data->weight > edge.weight) {
-                    route_internal_data = RouteInternalData{ edge.weight, edge_id };
+                if (arc.weight < routes_internal_data_.weights[row + arc.to]) {
+                    routes_internal_data_.weights[row + arc.to] = arc.weight;
+                    routes_internal_data_.prev_edges[row + arc.to] = arc.edge_id;
                 }
             }
         }
     }
 
-    void RelaxRoute(VertexId vertex_from, VertexId vertex_to, const RouteInternalData& route_from,
-        const RouteInternalData& route_to) {
-        auto& route_relaxing = routes_internal_data_[vertex_from][vertex_to];
-        const Weight candidate_weight = route_from.weight + route_to.weight;
-        if (!route_relaxing || candidate_weight < route_relaxing->weight) {
-            route_relaxing = { candidate_weight,
-                                route_to.prev_edge ? route_to.prev_edge : route_from.prev_edge };
+    void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through) {
+        RelaxRoutesInternalDataBlock(0, vertex_count, 0, vertex_count, vertex_through, vertex_through + 1);
+    }
+
+    // Релаксирует ячейки [row_begin, row_end) x [column_begin, column_end)
+    // через вершины [through_begin, through_end)
+    void RelaxRoutesInternalDataBlock(VertexId row_begin, VertexId row_end,
+        VertexId column_begin, VertexId column_end,
+        VertexId through_begin, VertexId through_end) {
+        for (VertexId vertex_through = through_begin; vertex_through < through_end; ++vertex_through) {
+            const Weight* through_weights = routes_internal_data_.weights.data() + vertex_through * vertex_count_;
+            const uint32_t* through_prev_edges = routes_internal_data_.prev_edges.data() + vertex_through * vertex_count_;
+            for (VertexId vertex_from = row_begin; vertex_from < row_end; ++vertex_from) {
+                Weight* from_weights = routes_internal_data_.weights.data() + vertex_from * vertex_count_;
+                uint32_t* from_prev_edges = routes_internal_data_.prev_edges.data() + vertex_from * vertex_count_;
+                const uint32_t prev_edge_from = from_prev_edges[vertex_through];
+                if (prev_edge_from == NO_ROUTE || vertex_from == vertex_through) {
+                    continue;
+                }
+                const Weight weight_from = from_weights[vertex_through];
+                // Без ветвлений, чтобы цикл векторизовался
+                for (VertexId vertex_to = column_begin; vertex_to < column_end; ++vertex_to) {
+                    const Weight candidate_weight = weight_from + through_weights[vertex_to];
+                    const uint32_t prev_edge_to = through_prev_edges[vertex_to];
+                    const bool is_shorter = candidate_weight < from_weights[vertex_to];
+                    from_weights[vertex_to] = is_shorter ? candidate_weight : from_weights[vertex_to];
+                    from_prev_edges[vertex_to] = is_shorter
+                        ? (prev_edge_to == NO_EDGE ? prev_edge_from : prev_edge_to)
+                        : from_prev_edges[vertex_to];
+                }
+            }
         }
     }
 
-    void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through) {
-        for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
-            if (const auto& route_from = routes_internal_data_[vertex_from][vertex_through]) {
-                for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
-                    if (const auto& route_to = routes_internal_data_[vertex_through][vertex_to]) {
-                        RelaxRoute(vertex_from, vertex_to, *route_from, *route_to);
+    // Блочный алгоритм Флойда-Уоршелла: на шаге block сначала считается диагональный блок,
+    // затем блоки его строки и столбца, затем все остальные; блоки внутри фазы независимы
+    void RelaxRoutesInternalDataBlocked(parallel::ThreadPool& thread_pool) {
+        const size_t block_count = (vertex_count_ + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        const auto block_begin = [](size_t block) { return block * BLOCK_SIZE; };
+        const auto block_end = [this](size_t block) { return std::min(vertex_count_, (block + 1) * BLOCK_SIZE); };
+
+        for (size_t block = 0; block < block_count; ++block) {
+            const VertexId through_begin = block_begin(block);
+            const VertexId through_end = block_end(block);
+            RelaxRoutesInternalDataBlock(through_begin, through_end, through_begin, through_end, through_begin, through_end);
+
+            thread_pool.ParallelFor(0, 2 * block_count, [&](size_t task) {
+                const size_t other = task / 2;
+                if (other == block) {
+                    return;
+                }
+                if (task % 2 == 0) {
+                    RelaxRoutesInternalDataBlock(through_begin, through_end, block_begin(other), block_end(other), through_begin, through_end);
+                }
+                else {
+                    RelaxRoutesInternalDataBlock(block_begin(other), block_end(other), through_begin, through_end, through_begin, through_end);
+                }
+            });
+
+            thread_pool.ParallelFor(0, block_count, [&](size_t row_block) {
+                if (row_block == block) {
+                    return;
+                }
+                for (size_t column_block = 0; column_block < block_count; ++column_block) {
+                    if (column_block != block) {
+                        RelaxRoutesInternalDataBlock(block_begin(row_block), block_end(row_block),
+                            block_begin(column_block), block_end(column_block), through_begin, through_end);
                     }
                 }
-            }
+            });
         }
     }
 
+    static constexpr size_t BLOCK_SIZE = 64;
     static constexpr Weight ZERO_WEIGHT{};
     const Graph& graph_;
-    RoutesInternalData routes_internal_data_;
+    size_t vertex_count_;
+    RoutesTable routes_internal_data_;
 };
 
 template <typename Weight>
 Router<Weight>::Router(const Graph& graph)
     : graph_(graph)
-    , routes_internal_data_(graph.GetVertexCount(),
-        std::vector<std::optional<RouteInternalData>>(graph.GetVertexCount()))
+    , vertex_count_(graph.GetVertexCount())
+    , routes_internal_data_{ std::vector<Weight>(vertex_count_ * vertex_count_, UNREACHABLE_WEIGHT),
+                             std::vector<uint32_t>(vertex_count_ * vertex_count_, NO_ROUTE) }
+{
+    if (graph.GetEdgeCount() >= NO_EDGE) {
+        throw std::length_error("Too many edges for routes table");
+    }
+    InitializeRoutesInternalData(graph);
+
+    for (VertexId vertex_through = 0; vertex_through < vertex_count_; ++vertex_through) {
+        RelaxRoutesInternalDataThroughVertex(vertex_count_, vertex_through);
+    }
+}
+
+template <typename Weight>
+Router<Weight>::Router(const Graph& graph, parallel::ThreadPool& thread_pool)
+    : graph_(graph)
+    , vertex_count_(graph.GetVertexCount())
+    , routes_internal_data_{ std::vector<Weight>(vertex_count_ * vertex_count_, UNREACHABLE_WEIGHT),
+                             std::vector<uint32_t>(vertex_count_ * vertex_count_, NO_ROUTE) }
 {
+    if (graph.GetEdgeCount() >= NO_EDGE) {
+        throw std::length_error("Too many edges for routes table");
+    }
     InitializeRoutesInternalData(graph);
+    RelaxRoutesInternalDataBlocked(thread_pool);
+}
 
-    const size_t vertex_count = graph.GetVertexCount();
-    for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
-        RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
+template <typename Weight>
+Router<Weight>::Router(const Graph& graph, RoutesTable routes_table)
+    : graph_(graph)
+    , vertex_count_(graph.GetVertexCount())
+    , routes_internal_data_(std::move(routes_table))
+{
+    if (routes_internal_data_.weights.size() != vertex_count_ * vertex_count_
+        || routes_internal_data_.prev_edges.size() != vertex_count_ * vertex_count_) {
+        throw std::invalid_argument("Routes table doesn't match the graph");
+    }
+    for (size_t index = 0; index < routes_internal_data_.prev_edges.size(); ++index) {
+        const uint32_t prev_edge = routes_internal_data_.prev_edges[index];
+        if (prev_edge == NO_ROUTE) {
+            routes_internal_data_.weights[index] = UNREACHABLE_WEIGHT;
+        }
+        else if (prev_edge != NO_EDGE && prev_edge >= graph.GetEdgeCount()) {
+            throw std::invalid_argument("Routes table doesn't match the graph");
+        }
     }
 }
 
+template <typename Weight>
+const typename Router<Weight>::RoutesTable& Router<Weight>::GetRoutesTable() const {
+    return routes_internal_data_;
+}
+
 template <typename Weight>
 std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
     VertexId to) const {
-    const auto& route_internal_data = routes_internal_data_.at(from).at(to);
-    if (!route_internal_data) {
+    if (from >= vertex_count_ || to >= vertex_count_) {
+        throw std::out_of_range("Vertex is out of graph");
+    }
+    const size_t row = from * vertex_count_;
+    if (routes_internal_data_.prev_edges[row + to] == NO_ROUTE) {
         return std::nullopt;
     }
-    const Weight weight = route_internal_data->weight;
+    const Weight weight = routes_internal_data_.weights[row + to];
     std::vector<EdgeId> edges;
-    for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
-        edge_id;
-        edge_id = routes_internal_data_[from][graph_.GetEdge(*edge_id).from]->prev_edge)
+    for (uint32_t edge_id = routes_internal_data_.prev_edges[row + to];
+        edge_id != NO_EDGE;
+        edge_id = routes_internal_data_.prev_edges[row + graph_.GetEdge(edge_id).from])
     {
-        edges.push_back(*edge_id);
+        edges.push_back(edge_id);
     }
     std::reverse(edges.begin(), edges.end());
 
     return RouteInfo{ weight, std::move(edges) };
 }
 
-}  // namespace graph
\ No newline at end of file
+template <typename Weight>
+std::vector<std::vector<std::optional<Weight>>> Router<Weight>::BuildWeightMatrix(const std::vector<VertexId>& sources,
+    const std::vector<VertexId>& targets) const {
+    std::vector<std::vector<std::optional<Weight>>> matrix;
+    matrix.reserve(sources.size());
+    for (const VertexId from : sources) {
+        if (from >= vertex_count_) {
+            throw std::out_of_range("Vertex is out of graph");
+        }
+        auto& row = matrix.emplace_back(targets.size());
+        const size_t row_begin = from * vertex_count_;
+        for (size_t i = 0; i < targets.size(); ++i) {
+            if (targets[i] >= vertex_count_) {
+                throw std::out_of_range("Vertex is out of graph");
+            }
+            if (routes_internal_data_.prev_edges[row_begin + targets[i]] != NO_ROUTE) {
+                row[i] = routes_internal_data_.weights[row_begin + targets[i]];
+            }
+        }
+    }
+    return matrix;
+}
+
+}  // namespace graph
@@ -1,22 +1,39 @@
 #include "serialization.h"
 
+#include <algorithm>
 #include <fstream>
+#include <type_traits>
 
 namespace serialization {
 
+namespace {
+
+// Веса хранятся в полях своего типа (см. WeightType); выполняется то из трёх действий,
+// которое соответствует RouteWeight
+template <typename AsDouble, typename AsFloat, typename AsFixed>
+decltype(auto) ForWeightType(AsDouble as_double, AsFloat as_float, AsFixed as_fixed) {
+    if constexpr (std::is_same_v<transport::RouteWeight, float>) return as_float();
+    else if constexpr (std::is_integral_v<transport::RouteWeight>) return as_fixed();
+    else return as_double();
+}
+
+} // namespace
+
 void Serialize(const transport::Catalogue& db, const renderer::MapRenderer& renderer, const transport::Router& router, std::ostream& out) {
     proto_transport::TransportCatalogue proto_db;
 
+    SerializeNames(db, proto_db);
     SerializeStops(db, proto_db);
     SerializeStopDistances(db, proto_db);
     SerializeBuses(db, proto_db);
+    SerializeStopIndex(db, proto_db);
     SerializeRenderSettings(renderer, proto_db);
-    SerializeRouter(router, proto_db);
+    SerializeRouter(db, router, proto_db);
     
     proto_db.SerializeToOstream(&out);
 }
 
-std::tuple<transport::Catalogue, renderer::MapRenderer, transport::Router, graph::DirectedWeightedGraph<double>, std::map<std::string, graph::VertexId>> Deserialize(std::istream& input) {
+std::tuple<transport::Catalogue, renderer::MapRenderer, transport::Router, graph::DirectedWeightedGraph<transport::RouteWeight>, size_t> Deserialize(std::istream& input) {
     proto_transport::TransportCatalogue proto_db;
     proto_db.ParseFromIstream(&input);
 
@@ -28,30 +45,76 @@ std::tuple<transport::Catalogue, renderer::MapRenderer, transport::Router, graph
     
     renderer::RenderSettings render_settings;
     renderer::MapRenderer renderer = DeserializeRenderSettings(render_settings, proto_db);
+    if (proto_db.router().graph().weight_type() != GetWeightType()) {
+        throw std::runtime_error("Error deserialized graph: base was built with another route weight type");
+    }
     transport::Router router = DeserializeRouterSettings(proto_db);
+    std::vector<std::string_view> router_names;
+    router_names.reserve(proto_db.router().name_id_size());
+    for (const uint32_t name_id : proto_db.router().name_id()) {
+        router_names.push_back(DeserializeName(db, proto_db, name_id));
+    }
+    router.SetNames(std::move(router_names));
+    if (proto_db.router().has_routes_table()) {
+        router.SetRoutesTable(DeserializeRoutesTable(proto_db.router().routes_table()));
+    }
+    if (proto_db.router().has_contraction_hierarchy()) {
+        router.SetHierarchyData(DeserializeHierarchyData(proto_db.router().contraction_hierarchy()));
+    }
+    if (proto_db.router().has_raptor()) {
+        router.SetRaptorData(DeserializeRaptorData(proto_db.router().raptor()));
+    }
+    if (proto_db.router().has_geo_bound()) {
+        router.SetGeoBoundData(DeserializeGeoBoundData(proto_db.router().geo_bound()));
+    }
+    if (proto_db.router().has_landmarks()) {
+        router.SetLandmarkData(DeserializeLandmarkData(proto_db.router().landmarks()));
+    }
     
-    return { std::move(db), std::move(renderer), std::move(router), DeserializeGraph(proto_db), DeserializeStopIds(proto_db) };
+    return { std::move(db), std::move(renderer), std::move(router), DeserializeGraph(proto_db), proto_db.router().stop_count() };
+}
+
+void SerializeNames(const transport::Catalogue& db, proto_transport::TransportCatalogue& proto_db) {
+    const transport::NameArena& names = db.GetNames();
+    proto_db.mutable_name()->Reserve(names.Size());
+    for (uint32_t name_id = 0; name_id < names.Size(); ++name_id) {
+        proto_db.add_name(std::string(names.Get(name_id)));
+    }
 }
 
+uint32_t SerializeName(const transport::Catalogue& db, std::string_view name) {
+    return db.GetNames().Find(name).value();
+}
+
+// Остановки записываются в порядке номеров, чтобы маршруты и расстояния ссылались на них по номеру
 void SerializeStops(const transport::Catalogue& db, proto_transport::TransportCatalogue& proto_db) {
-    const auto all_stops = db.GetSortedAllStops();
-    for (const auto& stop : all_stops) {
+    for (uint32_t stop_id = 0; stop_id < db.GetStopCount(); ++stop_id) {
+        const transport::Stop& stop = db.GetStop(stop_id);
         proto_transport::Stop proto_stop;
-        proto_stop.set_name(stop.second->name);
-        proto_stop.mutable_coordinates()->set_lat(stop.second->coordinates.lat);
-        proto_stop.mutable_coordinates()->set_lng(stop.second->coordinates.lng);
-        for (const auto& bus : stop.second->buses_by_stop) {
-            proto_stop.add_buses_by_stop(bus);
-        }
+        proto_stop.set_name_id(SerializeName(db, stop.name));
+        proto_stop.mutable_coordinates()->set_lat(stop.coordinates.lat);
+        proto_stop.mutable_coordinates()->set_lng(stop.coordinates.lng);
         *proto_db.add_stops() = std::move(proto_stop);
     }
 }
 
+void SerializeStopIndex(const transport::Catalogue& db, proto_transport::TransportCatalogue& proto_db) {
+    const geo::SpatialIndex::IndexData& index_data = db.GetStopIndex().GetIndexData();
+    proto_transport::SpatialIndex& proto_index = *proto_db.mutable_stop_index();
+    proto_index.mutable_stop()->Add(index_data.points.begin(), index_data.points.end());
+    proto_index.mutable_box()->Reserve(index_data.boxes.size() * 6);
+    for (const auto& [min, max] : index_data.boxes) {
+        for (const double value : { min.x, min.y, min.z, max.x, max.y, max.z }) {
+            proto_index.add_box(value);
+        }
+    }
+}
+
 void SerializeStopDistances(const transport::Catalogue& db, proto_transport::TransportCatalogue& proto_db) {
-    for (const auto& [stop_pair, distance] : db.GetStopDistances()) {
+    for (const auto& [from, to, distance] : db.GetStopDistances()) {
         proto_transport::StopDistanses proto_stop_distances;
-        proto_stop_distances.set_from(stop_pair.first->name);
-        proto_stop_distances.set_to(stop_pair.second->name);
+        proto_stop_distances.set_from(from);
+        proto_stop_distances.set_to(to);
         proto_stop_distances.set_distance(distance);
 
         *proto_db.add_stop_distances() = std::move(proto_stop_distances);
@@ -59,21 +122,29 @@ void SerializeStopDistances(const transport::Catalogue& db, proto_transport::Tra
 }
 
 void SerializeBuses(const transport::Catalogue& db, proto_transport::TransportCatalogue& proto_db) {
-    const auto all_buses = db.GetSortedAllBuses();
+    const auto& all_buses = db.GetSortedAllBuses();
     for (const auto& bus : all_buses) {
         proto_transport::Bus proto_bus;
-        proto_bus.set_number(bus.second->number);
+        proto_bus.set_number_id(SerializeName(db, bus.second->number));
+        proto_bus.mutable_stop()->Reserve(bus.second->stops.size());
         for (const auto* stop : bus.second->stops) {
-            *proto_bus.mutable_stops()->Add() = stop->name;
+            proto_bus.add_stop(stop->id);
         }
         proto_bus.set_is_circle(bus.second->is_circle);
+        if (const auto& stat = bus.second->stat) {
+            proto_transport::BusStat& proto_stat = *proto_bus.mutable_stat();
+            proto_stat.set_stops_count(stat->stops_count);
+            proto_stat.set_unique_stops_count(stat->unique_stops_count);
+            proto_stat.set_route_length(stat->route_length);
+            proto_stat.set_curvature(stat->curvature);
+        }
         
         *proto_db.add_buses() = std::move(proto_bus);
     }
 }
 
 void SerializeRenderSettings(const renderer::MapRenderer& renderer, proto_transport::TransportCatalogue& proto_db) {
-    const auto render_settings = renderer.GetRenderSettings();
+    const auto& render_settings = renderer.GetRenderSettings();
     proto_map::RenderSettings proto_render_settings;
     proto_render_settings.set_width(render_settings.width);
     proto_render_settings.set_height(render_settings.height);
@@ -138,16 +209,28 @@ proto_map::Rgba SerializeRgba(const svg::Rgba& rgba) {
     return proto_rgba;
 }
 
-void SerializeRouter(const transport::Router& router, proto_transport::TransportCatalogue& proto_db) {
+void SerializeRouter(const transport::Catalogue& db, const transport::Router& router, proto_transport::TransportCatalogue& proto_db) {
     proto_transport::Router proto_router;
-    *proto_router.mutable_router_settings() = SerializeRouterSettings(router.GetRouterSettings(), proto_db);
+    *proto_router.mutable_router_settings() = SerializeRouterSettings(router, proto_db);
     *proto_router.mutable_graph() = SerializeGraph(router, proto_db);
-    for (const auto& [name, id] : router.GetStopIds()) {
-        proto_transport::StopId proto_stop_id;
-        proto_stop_id.set_name(name);
-        proto_stop_id.set_id(id);
-        
-        *proto_router.add_stop_ids() = proto_stop_id;
+    proto_router.set_stop_count(router.GetStopIds().size());
+    for (const auto& name : router.GetNames()) {
+        proto_router.add_name_id(SerializeName(db, name));
+    }
+    if (const auto* routes_table = router.GetRoutesTable()) {
+        *proto_router.mutable_routes_table() = SerializeRoutesTable(*routes_table);
+    }
+    if (const auto* hierarchy_data = router.GetHierarchyData()) {
+        *proto_router.mutable_contraction_hierarchy() = SerializeHierarchyData(*hierarchy_data);
+    }
+    if (const auto* raptor_data = router.GetRaptorData()) {
+        *proto_router.mutable_raptor() = SerializeRaptorData(*raptor_data);
+    }
+    if (const auto* geo_bound_data = router.GetGeoBoundData()) {
+        *proto_router.mutable_geo_bound() = SerializeGeoBoundData(*geo_bound_data);
+    }
+    if (const auto* landmark_data = router.GetLandmarkData()) {
+        *proto_router.mutable_landmarks() = SerializeLandmarkData(*landmark_data);
     }
     *proto_db.mutable_router() = std::move(proto_router);
 }
@@ -156,20 +239,35 @@ proto_transport::RouterSettings SerializeRouterSettings(const transport::Router&
     proto_transport::RouterSettings proto_router_settings;
     proto_router_settings.set_bus_wait_time(router.GetBusWaitTime());
     proto_router_settings.set_bus_velocity(router.GetBusVelocity());
+    proto_router_settings.set_engine(static_cast<proto_transport::RouterEngine>(router.GetRoutingSettings().engine));
+    proto_router_settings.set_thread_count(router.GetRoutingSettings().thread_count);
+    proto_router_settings.set_graph_model(static_cast<proto_transport::GraphModel>(router.GetRoutingSettings().graph_model));
+    proto_router_settings.set_route_cache_size(router.GetRoutingSettings().route_cache_size);
+    proto_router_settings.set_search_heuristic(static_cast<proto_transport::SearchHeuristic>(router.GetRoutingSettings().search_heuristic));
+    proto_router_settings.set_landmark_count(router.GetRoutingSettings().landmark_count);
     
     return proto_router_settings;
 }
 
+proto_graph::WeightType GetWeightType() {
+    if constexpr (std::is_same_v<transport::RouteWeight, float>) return proto_graph::WEIGHT_FLOAT;
+    else if constexpr (std::is_integral_v<transport::RouteWeight>) return proto_graph::WEIGHT_FIXED;
+    else return proto_graph::WEIGHT_DOUBLE;
+}
+
 proto_graph::Graph SerializeGraph(const transport::Router& router, proto_transport::TransportCatalogue& proto_db) {
     proto_graph::Graph proto_graph;
+    proto_graph.set_weight_type(GetWeightType());
     for (int i = 0; i < router.GetGraph().GetEdgeCount(); ++i) {
         const graph::Edge edge = router.GetGraph().GetEdge(i);
         proto_graph::Edge proto_edge;
-        proto_edge.set_name(edge.name);
+        proto_edge.set_name_id(edge.name_id);
         proto_edge.set_quality(edge.quality);
         proto_edge.set_from(edge.from);
         proto_edge.set_to(edge.to);
-        proto_edge.set_weight(edge.weight);
+        ForWeightType([&] { proto_edge.set_weight(edge.weight); },
+                      [&] { proto_edge.set_weight_float(edge.weight); },
+                      [&] { proto_edge.set_weight_fixed(edge.weight); });
 
         *proto_graph.add_edge() = proto_edge;
     }
@@ -183,31 +281,146 @@ proto_graph::Graph SerializeGraph(const transport::Router& router, proto_transpo
     return proto_graph;
 }
 
+proto_graph::RoutesTable SerializeRoutesTable(const graph::Router<transport::RouteWeight>::RoutesTable& routes_table) {
+    proto_graph::RoutesTable proto_routes_table;
+    auto* proto_weights = ForWeightType([&] { return proto_routes_table.mutable_weight(); },
+                                        [&] { return proto_routes_table.mutable_weight_float(); },
+                                        [&] { return proto_routes_table.mutable_weight_fixed(); });
+    proto_routes_table.mutable_prev_edge()->Reserve(routes_table.prev_edges.size());
+    for (size_t i = 0; i < routes_table.prev_edges.size(); ++i) {
+        const uint32_t prev_edge = routes_table.prev_edges[i];
+        if (prev_edge != graph::Router<transport::RouteWeight>::NO_ROUTE) proto_weights->Add(routes_table.weights[i]);
+        if (prev_edge == graph::Router<transport::RouteWeight>::NO_ROUTE) proto_routes_table.add_prev_edge(0);
+        else if (prev_edge == graph::Router<transport::RouteWeight>::NO_EDGE) proto_routes_table.add_prev_edge(1);
+        else proto_routes_table.add_prev_edge(prev_edge + 2);
+    }
+    return proto_routes_table;
+}
+
+proto_transport::Raptor SerializeRaptorData(const transport::RaptorData& raptor_data) {
+    proto_transport::Raptor proto_raptor;
+    proto_raptor.set_stop_count(raptor_data.stop_count);
+    proto_raptor.mutable_route()->Reserve(raptor_data.routes.size());
+    for (const auto& route : raptor_data.routes) {
+        proto_transport::RaptorRoute* proto_route = proto_raptor.add_route();
+        proto_route->set_name_id(route.name_id);
+        proto_route->mutable_stop()->Add(route.stops.begin(), route.stops.end());
+        proto_route->mutable_distance()->Add(route.distances.begin(), route.distances.end());
+    }
+    return proto_raptor;
+}
+
+proto_transport::GeoBound SerializeGeoBoundData(const transport::GeoBoundData& geo_bound_data) {
+    proto_transport::GeoBound proto_geo_bound;
+    proto_geo_bound.set_time_per_meter(geo_bound_data.time_per_meter);
+    proto_geo_bound.mutable_vertex_stop()->Add(geo_bound_data.vertex_stops.begin(), geo_bound_data.vertex_stops.end());
+    for (const auto& coordinates : geo_bound_data.stop_coordinates) {
+        proto_geo_bound.add_stop_latitude(coordinates.lat);
+        proto_geo_bound.add_stop_longitude(coordinates.lng);
+    }
+    return proto_geo_bound;
+}
+
+proto_graph::Landmarks SerializeLandmarkData(const graph::Landmarks<transport::RouteWeight>::LandmarkData& landmark_data) {
+    proto_graph::Landmarks proto_landmarks;
+    proto_landmarks.mutable_vertex()->Add(landmark_data.vertices.begin(), landmark_data.vertices.end());
+    ForWeightType([&] { return proto_landmarks.mutable_from_weight(); },
+                  [&] { return proto_landmarks.mutable_from_weight_float(); },
+                  [&] { return proto_landmarks.mutable_from_weight_fixed(); })
+        ->Add(landmark_data.from_weights.begin(), landmark_data.from_weights.end());
+    ForWeightType([&] { return proto_landmarks.mutable_to_weight(); },
+                  [&] { return proto_landmarks.mutable_to_weight_float(); },
+                  [&] { return proto_landmarks.mutable_to_weight_fixed(); })
+        ->Add(landmark_data.to_weights.begin(), landmark_data.to_weights.end());
+    return proto_landmarks;
+}
+
+proto_graph::ContractionHierarchy SerializeHierarchyData(const graph::ContractionHierarchy<transport::RouteWeight>::HierarchyData& hierarchy_data) {
+    proto_graph::ContractionHierarchy proto_hierarchy;
+    proto_hierarchy.mutable_rank()->Reserve(hierarchy_data.ranks.size());
+    for (const size_t rank : hierarchy_data.ranks) {
+        proto_hierarchy.add_rank(rank);
+    }
+    proto_hierarchy.mutable_edge()->Reserve(hierarchy_data.edges.size());
+    for (const auto& edge : hierarchy_data.edges) {
+        proto_graph::HierarchyEdge* proto_edge = proto_hierarchy.add_edge();
+        proto_edge->set_from(edge.from);
+        proto_edge->set_to(edge.to);
+        ForWeightType([&] { proto_edge->set_weight(edge.weight); },
+                      [&] { proto_edge->set_weight_float(edge.weight); },
+                      [&] { proto_edge->set_weight_fixed(edge.weight); });
+        if (edge.original_edge == graph::ContractionHierarchy<transport::RouteWeight>::NO_EDGE) {
+            proto_edge->set_first(edge.first);
+            proto_edge->set_second(edge.second);
+        }
+        else {
+            proto_edge->set_original_edge(edge.original_edge + 1);
+        }
+    }
+    return proto_hierarchy;
+}
+
+// Остановки добавляются в порядке записи, поэтому получают те же номера, что и при построении базы
 void DeserializeStops(transport::Catalogue& db, const proto_transport::TransportCatalogue& proto_db) {
     for (int i = 0; i < proto_db.stops_size(); ++i) {
         const proto_transport::Stop& proto_stop = proto_db.stops(i);
-        db.AddStop(proto_stop.name(), { proto_stop.coordinates().lat(), proto_stop.coordinates().lng() });
+        db.AddStop(proto_db.name().at(proto_stop.name_id()), { proto_stop.coordinates().lat(), proto_stop.coordinates().lng() });
+    }
+    if (proto_db.has_stop_index()) {
+        db.SetStopIndex(DeserializeStopIndex(proto_db.stop_index()));
     }
 }
 
+geo::SpatialIndex::IndexData DeserializeStopIndex(const proto_transport::SpatialIndex& proto_index) {
+    if (proto_index.box_size() % 6 != 0) {
+        throw std::runtime_error("Error deserialized stop index: box data is truncated");
+    }
+    geo::SpatialIndex::IndexData index_data;
+    index_data.points.assign(proto_index.stop().begin(), proto_index.stop().end());
+    index_data.boxes.reserve(proto_index.box_size() / 6);
+    for (int i = 0; i < proto_index.box_size(); i += 6) {
+        const auto& box = proto_index.box();
+        index_data.boxes.push_back({ { box[i], box[i + 1], box[i + 2] }, { box[i + 3], box[i + 4], box[i + 5] } });
+    }
+    return index_data;
+}
+
 void DeserializeStopDistances(transport::Catalogue& db, const proto_transport::TransportCatalogue& proto_db) {
     for (int i = 0; i < proto_db.stop_distances_size(); ++i) {
         const proto_transport::StopDistanses& proto_stop_distances = proto_db.stop_distances(i);
-        const transport::Stop* from = db.FindStop(proto_stop_distances.from());
-        const transport::Stop* to = db.FindStop(proto_stop_distances.to());
+        const transport::Stop* from = &db.GetStop(proto_stop_distances.from());
+        const transport::Stop* to = &db.GetStop(proto_stop_distances.to());
         db.SetDistance(from, to, proto_stop_distances.distance());
     }
 }
 
+// Строка таблицы имён базы в виде ссылки на хранилище имён каталога
+std::string_view DeserializeName(const transport::Catalogue& db, const proto_transport::TransportCatalogue& proto_db, uint32_t name_id) {
+    const auto catalogue_name_id = db.GetNames().Find(proto_db.name().at(name_id));
+    if (!catalogue_name_id) {
+        throw std::runtime_error("Error deserialized router: name is missing in catalogue");
+    }
+    return db.GetNames().Get(*catalogue_name_id);
+}
+
 void DeserializeBuses(transport::Catalogue& db, const proto_transport::TransportCatalogue& proto_db) {
     for (int i = 0; i < proto_db.buses_size(); ++i) {
         const proto_transport::Bus& proto_bus = proto_db.buses(i);
-        std::vector<const transport::Stop*> stops(proto_bus.stops_size());
+        std::vector<const transport::Stop*> stops(proto_bus.stop_size());
         for (int j = 0; j < stops.size(); ++j) {
-            stops[j] = db.FindStop(proto_bus.stops(j));
+            stops[j] = &db.GetStop(proto_bus.stop(j));
+        }
+        const std::string& number = proto_db.name().at(proto_bus.number_id());
+        db.AddRoute(number, std::move(stops), proto_bus.is_circle());
+        if (proto_bus.has_stat()) {
+            const proto_transport::BusStat& proto_stat = proto_bus.stat();
+            db.SetBusStat(number, { static_cast<size_t>(proto_stat.stops_count()),
+                                                static_cast<size_t>(proto_stat.unique_stops_count()),
+                                                proto_stat.route_length(),
+                                                proto_stat.curvature() });
         }
-        db.AddRoute(proto_bus.number(), stops, proto_bus.is_circle());
     }
+    db.Finalize();
 }
 
 renderer::MapRenderer DeserializeRenderSettings(renderer::RenderSettings& render_settings, const proto_transport::TransportCatalogue& proto_db) {
@@ -247,20 +460,32 @@ svg::Color DeserializeColor(const proto_map::Color& proto_color) {
 }
 
 transport::Router DeserializeRouterSettings(const proto_transport::TransportCatalogue& proto_db) {
-    return { proto_db.router().router_settings().bus_wait_time(), proto_db.router().router_settings().bus_velocity()};
+    const proto_transport::RouterSettings& proto_router_settings = proto_db.router().router_settings();
+    transport::RoutingSettings routing_settings;
+    routing_settings.bus_wait_time = proto_router_settings.bus_wait_time();
+    routing_settings.bus_velocity = proto_router_settings.bus_velocity();
+    routing_settings.engine = static_cast<transport::RouterEngine>(proto_router_settings.engine());
+    routing_settings.thread_count = proto_router_settings.thread_count();
+    routing_settings.graph_model = static_cast<transport::GraphModel>(proto_router_settings.graph_model());
+    routing_settings.route_cache_size = proto_router_settings.route_cache_size();
+    routing_settings.search_heuristic = static_cast<transport::SearchHeuristic>(proto_router_settings.search_heuristic());
+    routing_settings.landmark_count = proto_router_settings.landmark_count();
+    return transport::Router{ routing_settings };
 }
 
-graph::DirectedWeightedGraph<double> DeserializeGraph(const proto_transport::TransportCatalogue& proto_db) {
+graph::DirectedWeightedGraph<transport::RouteWeight> DeserializeGraph(const proto_transport::TransportCatalogue& proto_db) {
     const proto_graph::Graph& proto_graph = proto_db.router().graph();
-    std::vector<graph::Edge<double>> edges(proto_graph.edge_size());
+    std::vector<graph::Edge<transport::RouteWeight>> edges(proto_graph.edge_size());
     std::vector<std::vector<graph::EdgeId>> incidence_lists(proto_graph.vertex_size());
     for (int i = 0; i < proto_graph.edge_size(); ++i) {
         const proto_graph::Edge& proto_edge = proto_graph.edge(i);
-        edges[i] = { proto_edge.name(),
+        edges[i] = { proto_edge.name_id(),
                      static_cast<size_t>(proto_edge.quality()),
                      static_cast<size_t>(proto_edge.from()),
                      static_cast<size_t>(proto_edge.to()),
-                     proto_edge.weight() };
+                     ForWeightType([&] { return static_cast<transport::RouteWeight>(proto_edge.weight()); },
+                                   [&] { return static_cast<transport::RouteWeight>(proto_edge.weight_float()); },
+                                   [&] { return static_cast<transport::RouteWeight>(proto_edge.weight_fixed()); }) };
     }
     for (size_t i = 0; i < incidence_lists.size(); ++i) {
         const proto_graph::Vertex& proto_vertex = proto_graph.vertex(i);
@@ -269,15 +494,93 @@ graph::DirectedWeightedGraph<double> DeserializeGraph(const proto_transport::Tra
             incidence_lists[i].push_back(id);
         }
     }
-    return graph::DirectedWeightedGraph<double>(edges, incidence_lists);
+    return graph::DirectedWeightedGraph<transport::RouteWeight>(std::move(edges), std::move(incidence_lists));
+}
+
+graph::Router<transport::RouteWeight>::RoutesTable DeserializeRoutesTable(const proto_graph::RoutesTable& proto_routes_table) {
+    graph::Router<transport::RouteWeight>::RoutesTable routes_table;
+    const auto& proto_weights = ForWeightType([&]() -> decltype(auto) { return proto_routes_table.weight(); },
+                                              [&]() -> decltype(auto) { return proto_routes_table.weight_float(); },
+                                              [&]() -> decltype(auto) { return proto_routes_table.weight_fixed(); });
+    const int reachable_count = static_cast<int>(std::count_if(proto_routes_table.prev_edge().begin(),
+        proto_routes_table.prev_edge().end(), [](uint32_t prev_edge) { return prev_edge != 0; }));
+    if (proto_weights.size() != reachable_count) {
+        throw std::runtime_error("Error deserialized routes table: weights don't match routes");
+    }
+    routes_table.weights.reserve(proto_routes_table.prev_edge_size());
+    routes_table.prev_edges.reserve(proto_routes_table.prev_edge_size());
+    int weight_index = 0;
+    for (const uint32_t prev_edge : proto_routes_table.prev_edge()) {
+        if (prev_edge == 0) {
+            routes_table.weights.push_back(graph::GetUnreachableWeight<transport::RouteWeight>());
+            routes_table.prev_edges.push_back(graph::Router<transport::RouteWeight>::NO_ROUTE);
+            continue;
+        }
+        routes_table.weights.push_back(static_cast<transport::RouteWeight>(proto_weights[weight_index++]));
+        if (prev_edge == 1) routes_table.prev_edges.push_back(graph::Router<transport::RouteWeight>::NO_EDGE);
+        else routes_table.prev_edges.push_back(prev_edge - 2);
+    }
+    return routes_table;
+}
+
+graph::ContractionHierarchy<transport::RouteWeight>::HierarchyData DeserializeHierarchyData(const proto_graph::ContractionHierarchy& proto_hierarchy) {
+    graph::ContractionHierarchy<transport::RouteWeight>::HierarchyData hierarchy_data;
+    hierarchy_data.ranks.assign(proto_hierarchy.rank().begin(), proto_hierarchy.rank().end());
+    hierarchy_data.edges.reserve(proto_hierarchy.edge_size());
+    for (const auto& proto_edge : proto_hierarchy.edge()) {
+        const bool is_shortcut = proto_edge.original_edge() == 0;
+        const transport::RouteWeight weight = ForWeightType(
+            [&] { return static_cast<transport::RouteWeight>(proto_edge.weight()); },
+            [&] { return static_cast<transport::RouteWeight>(proto_edge.weight_float()); },
+            [&] { return static_cast<transport::RouteWeight>(proto_edge.weight_fixed()); });
+        hierarchy_data.edges.push_back({ proto_edge.from(),
+                                         proto_edge.to(),
+                                         weight,
+                                         is_shortcut ? graph::ContractionHierarchy<transport::RouteWeight>::NO_EDGE : proto_edge.original_edge() - 1,
+                                         proto_edge.first(),
+                                         proto_edge.second() });
+    }
+    return hierarchy_data;
+}
+
+transport::GeoBoundData DeserializeGeoBoundData(const proto_transport::GeoBound& proto_geo_bound) {
+    transport::GeoBoundData geo_bound_data;
+    geo_bound_data.time_per_meter = proto_geo_bound.time_per_meter();
+    geo_bound_data.vertex_stops.assign(proto_geo_bound.vertex_stop().begin(), proto_geo_bound.vertex_stop().end());
+    if (proto_geo_bound.stop_latitude_size() != proto_geo_bound.stop_longitude_size()) {
+        throw std::runtime_error("Error deserialized A* data");
+    }
+    geo_bound_data.stop_coordinates.reserve(proto_geo_bound.stop_latitude_size());
+    for (int i = 0; i < proto_geo_bound.stop_latitude_size(); ++i) {
+        geo_bound_data.stop_coordinates.push_back({ proto_geo_bound.stop_latitude(i), proto_geo_bound.stop_longitude(i) });
+    }
+    return geo_bound_data;
+}
+
+graph::Landmarks<transport::RouteWeight>::LandmarkData DeserializeLandmarkData(const proto_graph::Landmarks& proto_landmarks) {
+    graph::Landmarks<transport::RouteWeight>::LandmarkData landmark_data;
+    landmark_data.vertices.assign(proto_landmarks.vertex().begin(), proto_landmarks.vertex().end());
+    const auto& from_weights = ForWeightType([&]() -> decltype(auto) { return proto_landmarks.from_weight(); },
+                                             [&]() -> decltype(auto) { return proto_landmarks.from_weight_float(); },
+                                             [&]() -> decltype(auto) { return proto_landmarks.from_weight_fixed(); });
+    const auto& to_weights = ForWeightType([&]() -> decltype(auto) { return proto_landmarks.to_weight(); },
+                                           [&]() -> decltype(auto) { return proto_landmarks.to_weight_float(); },
+                                           [&]() -> decltype(auto) { return proto_landmarks.to_weight_fixed(); });
+    landmark_data.from_weights.assign(from_weights.begin(), from_weights.end());
+    landmark_data.to_weights.assign(to_weights.begin(), to_weights.end());
+    return landmark_data;
 }
 
-std::map<std::string, graph::VertexId> DeserializeStopIds(const proto_transport::TransportCatalogue& proto_db) {
-    std::map<std::string, graph::VertexId> stop_ids;
-    for (const auto& proto_stop_id : proto_db.router().stop_ids()) {
-        stop_ids[proto_stop_id.name()] = proto_stop_id.id();
+transport::RaptorData DeserializeRaptorData(const proto_transport::Raptor& proto_raptor) {
+    transport::RaptorData raptor_data;
+    raptor_data.stop_count = proto_raptor.stop_count();
+    raptor_data.routes.reserve(proto_raptor.route_size());
+    for (const auto& proto_route : proto_raptor.route()) {
+        raptor_data.routes.push_back({ proto_route.name_id(),
+                                       { proto_route.stop().begin(), proto_route.stop().end() },
+                                       { proto_route.distance().begin(), proto_route.distance().end() } });
     }
-    return stop_ids;
+    return raptor_data;
 }
 
 } // serialization
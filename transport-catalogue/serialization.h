@@ -10,9 +10,12 @@
 namespace serialization {
 
 void Serialize(const transport::Catalogue& db, const renderer::MapRenderer& renderer, const transport::Router& router, std::ostream& out);
-std::tuple<transport::Catalogue, renderer::MapRenderer, transport::Router, graph::DirectedWeightedGraph<double>, std::map<std::string, graph::VertexId>> Deserialize(std::istream& input);
+std::tuple<transport::Catalogue, renderer::MapRenderer, transport::Router, graph::DirectedWeightedGraph<transport::RouteWeight>, size_t> Deserialize(std::istream& input);
 
+void SerializeNames(const transport::Catalogue& db, proto_transport::TransportCatalogue& proto_db);
+uint32_t SerializeName(const transport::Catalogue& db, std::string_view name);
 void SerializeStops(const transport::Catalogue& db, proto_transport::TransportCatalogue& proto_db);
+void SerializeStopIndex(const transport::Catalogue& db, proto_transport::TransportCatalogue& proto_db);
 void SerializeStopDistances(const transport::Catalogue& db, proto_transport::TransportCatalogue& proto_db);
 void SerializeBuses(const transport::Catalogue& db, proto_transport::TransportCatalogue& proto_db);
 void SerializeRenderSettings(const renderer::MapRenderer& renderer, proto_transport::TransportCatalogue& proto_db);
@@ -20,18 +23,30 @@ proto_map::Point SerializePoint(const svg::Point& point);
 proto_map::Color SerializeColor(const svg::Color& color);
 proto_map::Rgb SerializeRgb(const svg::Rgb& rgb);
 proto_map::Rgba SerializeRgba(const svg::Rgba& rgba);
-void SerializeRouter(const transport::Router& router, proto_transport::TransportCatalogue& proto_db);
+void SerializeRouter(const transport::Catalogue& db, const transport::Router& router, proto_transport::TransportCatalogue& proto_db);
 proto_transport::RouterSettings SerializeRouterSettings(const transport::Router& router, proto_transport::TransportCatalogue& proto_db);
+proto_graph::WeightType GetWeightType();
 proto_graph::Graph SerializeGraph(const transport::Router& router, proto_transport::TransportCatalogue& proto_db);
+proto_graph::RoutesTable SerializeRoutesTable(const graph::Router<transport::RouteWeight>::RoutesTable& routes_table);
+proto_graph::ContractionHierarchy SerializeHierarchyData(const graph::ContractionHierarchy<transport::RouteWeight>::HierarchyData& hierarchy_data);
+proto_transport::Raptor SerializeRaptorData(const transport::RaptorData& raptor_data);
+proto_transport::GeoBound SerializeGeoBoundData(const transport::GeoBoundData& geo_bound_data);
+proto_graph::Landmarks SerializeLandmarkData(const graph::Landmarks<transport::RouteWeight>::LandmarkData& landmark_data);
 
 void DeserializeStops(transport::Catalogue& db, const proto_transport::TransportCatalogue& proto_db);
+geo::SpatialIndex::IndexData DeserializeStopIndex(const proto_transport::SpatialIndex& proto_index);
 void DeserializeStopDistances(transport::Catalogue& db, const proto_transport::TransportCatalogue& proto_db);
+std::string_view DeserializeName(const transport::Catalogue& db, const proto_transport::TransportCatalogue& proto_db, uint32_t name_id);
 void DeserializeBuses(transport::Catalogue& db, const proto_transport::TransportCatalogue& proto_db);
 renderer::MapRenderer DeserializeRenderSettings(renderer::RenderSettings& render_settings, const proto_transport::TransportCatalogue& proto_db);
 svg::Point DeserializePoint(const proto_map::Point& proto_point);
 svg::Color DeserializeColor(const proto_map::Color& proto_color);
 transport::Router DeserializeRouterSettings(const proto_transport::TransportCatalogue& proto_db);
-graph::DirectedWeightedGraph<double> DeserializeGraph(const proto_transport::TransportCatalogue& proto_db);
-std::map<std::string, graph::VertexId> DeserializeStopIds(const proto_transport::TransportCatalogue& proto_db);
+graph::DirectedWeightedGraph<transport::RouteWeight> DeserializeGraph(const proto_transport::TransportCatalogue& proto_db);
+graph::Router<transport::RouteWeight>::RoutesTable DeserializeRoutesTable(const proto_graph::RoutesTable& proto_routes_table);
+graph::ContractionHierarchy<transport::RouteWeight>::HierarchyData DeserializeHierarchyData(const proto_graph::ContractionHierarchy& proto_hierarchy);
+transport::RaptorData DeserializeRaptorData(const proto_transport::Raptor& proto_raptor);
+transport::GeoBoundData DeserializeGeoBoundData(const proto_transport::GeoBound& proto_geo_bound);
+graph::Landmarks<transport::RouteWeight>::LandmarkData DeserializeLandmarkData(const proto_graph::Landmarks& proto_landmarks);
 
 } // serialization
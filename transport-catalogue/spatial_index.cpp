@@ -0,0 +1,227 @@
+#define _USE_MATH_DEFINES
+
+#include "spatial_index.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <stdexcept>
+#include <tuple>
+
+namespace geo {
+
+namespace {
+
+using Box = SpatialIndex::Box;
+
+double ComputeSquaredChord(const UnitVector& from, const UnitVector& to) {
+    const double dx = from.x - to.x;
+    const double dy = from.y - to.y;
+    const double dz = from.z - to.z;
+    return dx * dx + dy * dy + dz * dz;
+}
+
+// Квадрат расстояния от точки до параллелепипеда, ноль для точки внутри него
+double ComputeSquaredChord(const UnitVector& point, const Box& box) {
+    const auto axis_distance = [](double value, double min, double max) {
+        return value < min ? min - value : (value > max ? value - max : 0.0);
+    };
+    const double dx = axis_distance(point.x, box.min.x, box.max.x);
+    const double dy = axis_distance(point.y, box.min.y, box.max.y);
+    const double dz = axis_distance(point.z, box.min.z, box.max.z);
+    return dx * dx + dy * dy + dz * dz;
+}
+
+Box MakeBox(const UnitVector& point) {
+    return { point, point };
+}
+
+void ExtendBox(Box& box, const Box& other) {
+    box.min = { std::min(box.min.x, other.min.x), std::min(box.min.y, other.min.y), std::min(box.min.z, other.min.z) };
+    box.max = { std::max(box.max.x, other.max.x), std::max(box.max.y, other.max.y), std::max(box.max.z, other.max.z) };
+}
+
+// Сортирует [first, last) по одной координате; при равенстве - по номеру точки, чтобы дерево
+// не зависело от реализации сортировки
+template <typename Iterator, typename Axis>
+void SortByAxis(Iterator first, Iterator last, const std::vector<UnitVector>& vectors, Axis axis) {
+    std::sort(first, last, [&vectors, axis](uint32_t lhs, uint32_t rhs) {
+        return std::make_pair(vectors[lhs].*axis, lhs) < std::make_pair(vectors[rhs].*axis, rhs);
+    });
+}
+
+std::vector<UnitVector> ToUnitVectors(const PointArrays& points) {
+    std::vector<UnitVector> vectors;
+    vectors.reserve(points.Size());
+    for (size_t i = 0; i < points.Size(); ++i) {
+        vectors.push_back(ToUnitVector({ points.lat[i], points.lng[i] }));
+    }
+    return vectors;
+}
+
+} // namespace
+
+// Сортировка по плиткам: точки делятся на S слоёв по x, слои - на S полос по y, полосы
+// сортируются по z, где S - кубический корень из числа листьев
+SpatialIndex::SpatialIndex(const PointArrays& points) {
+    const std::vector<UnitVector> vectors = ToUnitVectors(points);
+    const size_t point_count = vectors.size();
+    std::vector<uint32_t>& order = index_data_.points;
+    order.resize(point_count);
+    std::iota(order.begin(), order.end(), 0);
+
+    const size_t leaf_count = (point_count + NODE_SIZE - 1) / NODE_SIZE;
+    const size_t slice_count = static_cast<size_t>(std::ceil(std::cbrt(static_cast<double>(leaf_count))));
+    const size_t slice_size = NODE_SIZE * std::max<size_t>(slice_count, 1);
+    const size_t slab_size = slice_size * std::max<size_t>(slice_count, 1);
+    SortByAxis(order.begin(), order.end(), vectors, &UnitVector::x);
+    for (size_t slab = 0; slab < point_count; slab += slab_size) {
+        const size_t slab_end = std::min(slab + slab_size, point_count);
+        SortByAxis(order.begin() + slab, order.begin() + slab_end, vectors, &UnitVector::y);
+        for (size_t slice = slab; slice < slab_end; slice += slice_size) {
+            const size_t slice_end = std::min(slice + slice_size, slab_end);
+            SortByAxis(order.begin() + slice, order.begin() + slice_end, vectors, &UnitVector::z);
+        }
+    }
+
+    vectors_.reserve(point_count);
+    for (const uint32_t point : order) {
+        vectors_.push_back(vectors[point]);
+    }
+    BuildBoxes();
+}
+
+SpatialIndex::SpatialIndex(const PointArrays& points, IndexData index_data)
+    : index_data_(std::move(index_data))
+{
+    const std::vector<UnitVector> vectors = ToUnitVectors(points);
+    const std::vector<size_t> level_sizes = ComputeLevelSizes(vectors.size());
+    if (index_data_.points.size() != vectors.size()
+        || index_data_.boxes.size() != std::accumulate(level_sizes.begin(), level_sizes.end(), size_t{ 0 })) {
+        throw std::invalid_argument("Spatial index doesn't match the points");
+    }
+    std::vector<bool> is_indexed(vectors.size(), false);
+    vectors_.reserve(vectors.size());
+    for (const uint32_t point : index_data_.points) {
+        if (point >= vectors.size() || is_indexed[point]) {
+            throw std::invalid_argument("Spatial index doesn't match the points");
+        }
+        is_indexed[point] = true;
+        vectors_.push_back(vectors[point]);
+    }
+    level_offsets_.assign(1, 0);
+    for (const size_t level_size : level_sizes) {
+        level_offsets_.push_back(level_offsets_.back() + level_size);
+    }
+}
+
+const SpatialIndex::IndexData& SpatialIndex::GetIndexData() const {
+    return index_data_;
+}
+
+std::vector<size_t> SpatialIndex::ComputeLevelSizes(size_t point_count) {
+    std::vector<size_t> level_sizes;
+    if (point_count == 0) {
+        return level_sizes;
+    }
+    size_t node_count = point_count;
+    do {
+        node_count = (node_count + NODE_SIZE - 1) / NODE_SIZE;
+        level_sizes.push_back(node_count);
+    } while (node_count > 1);
+    return level_sizes;
+}
+
+void SpatialIndex::BuildBoxes() {
+    const std::vector<size_t> level_sizes = ComputeLevelSizes(vectors_.size());
+    auto& boxes = index_data_.boxes;
+    boxes.clear();
+    level_offsets_.assign(1, 0);
+    for (size_t level = 0; level < level_sizes.size(); ++level) {
+        // Дети узла i - точки или узлы предыдущего уровня [i * NODE_SIZE, (i + 1) * NODE_SIZE)
+        const size_t child_count = level == 0 ? vectors_.size() : level_sizes[level - 1];
+        const size_t child_offset = level == 0 ? 0 : level_offsets_[level - 1];
+        for (size_t node = 0; node < level_sizes[level]; ++node) {
+            const size_t first = node * NODE_SIZE;
+            const size_t last = std::min(first + NODE_SIZE, child_count);
+            const auto child_box = [&](size_t child) {
+                return level == 0 ? MakeBox(vectors_[child]) : boxes[child_offset + child];
+            };
+            Box box = child_box(first);
+            for (size_t child = first + 1; child < last; ++child) {
+                ExtendBox(box, child_box(child));
+            }
+            boxes.push_back(box);
+        }
+        level_offsets_.push_back(boxes.size());
+    }
+}
+
+// Поиск по возрастанию расстояния до узлов: узел раскрывается, только если он ближе
+// радиуса и самой дальней из уже найденных count точек
+std::vector<std::pair<uint32_t, double>> SpatialIndex::FindNearest(Coordinates center, size_t count, double radius) const {
+    std::vector<std::pair<uint32_t, double>> result;
+    if (count == 0 || vectors_.empty() || radius < 0) {
+        return result;
+    }
+    const UnitVector center_vector = ToUnitVector(center);
+    // Хорда, стягивающая дугу radius; небольшой запас на погрешность, точная проверка - по дуге
+    const double angle = radius / EARTH_RADIUS;
+    const double max_squared_chord = angle >= M_PI
+        ? std::numeric_limits<double>::infinity()
+        : std::pow(2 * std::sin(angle / 2), 2) * (1 + 1e-9);
+
+    using NodeItem = std::tuple<double, size_t, size_t>;  // (квадрат хорды, уровень, узел)
+    using PointItem = std::pair<double, uint32_t>;        // (квадрат хорды, номер точки)
+    std::priority_queue<NodeItem, std::vector<NodeItem>, std::greater<NodeItem>> nodes;
+    std::priority_queue<PointItem> nearest;
+    const size_t root_level = level_offsets_.size() - 2;
+    nodes.emplace(ComputeSquaredChord(center_vector, index_data_.boxes[level_offsets_[root_level]]), root_level, 0);
+
+    while (!nodes.empty()) {
+        const auto [node_chord, level, node] = nodes.top();
+        nodes.pop();
+        if (node_chord > max_squared_chord || (nearest.size() == count && node_chord > nearest.top().first)) {
+            break;
+        }
+        const size_t first = node * NODE_SIZE;
+        if (level == 0) {
+            const size_t last = std::min(first + NODE_SIZE, vectors_.size());
+            for (size_t position = first; position < last; ++position) {
+                const PointItem item{ ComputeSquaredChord(center_vector, vectors_[position]), index_data_.points[position] };
+                if (item.first > max_squared_chord) {
+                    continue;
+                }
+                if (nearest.size() < count) {
+                    nearest.push(item);
+                }
+                else if (item < nearest.top()) {
+                    nearest.pop();
+                    nearest.push(item);
+                }
+            }
+        }
+        else {
+            const size_t last = std::min(first + NODE_SIZE, level_offsets_[level] - level_offsets_[level - 1]);
+            for (size_t child = first; child < last; ++child) {
+                nodes.emplace(ComputeSquaredChord(center_vector, index_data_.boxes[level_offsets_[level - 1] + child]),
+                    level - 1, child);
+            }
+        }
+    }
+
+    result.reserve(nearest.size());
+    for (; !nearest.empty(); nearest.pop()) {
+        const auto [squared_chord, point] = nearest.top();
+        const double distance = 2 * std::asin(std::min(1.0, std::sqrt(squared_chord) / 2)) * EARTH_RADIUS;
+        if (distance <= radius) {
+            result.emplace_back(point, distance);
+        }
+    }
+    std::reverse(result.begin(), result.end());
+    return result;
+}
+
+}  // namespace geo
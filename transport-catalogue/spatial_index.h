@@ -0,0 +1,54 @@
+#pragma once
+
+#include "geo.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace geo {
+
+// Упакованное R-дерево над точками поверхности Земли. Точки хранятся единичными векторами:
+// ближайшие по хорде точки - ближайшие и по поверхности, поэтому поиск идёт в трёхмерном
+// пространстве без особых случаев у полюсов и линии перемены дат. Точки упорядочиваются
+// сортировкой по плиткам (STR) и группируются по NODE_SIZE в листья, каждый следующий
+// уровень группирует по NODE_SIZE узлов предыдущего
+class SpatialIndex {
+public:
+    static constexpr size_t NODE_SIZE = 16;
+
+    // Ограничивающий параллелепипед узла
+    struct Box {
+        UnitVector min;
+        UnitVector max;
+    };
+
+    // points - номера точек в порядке листьев; boxes - узлы по уровням, начиная с листьев
+    struct IndexData {
+        std::vector<uint32_t> points;
+        std::vector<Box> boxes;
+    };
+
+    SpatialIndex() = default;
+    explicit SpatialIndex(const PointArrays& points);
+    // Принимает готовое дерево, не перестраивая его
+    SpatialIndex(const PointArrays& points, IndexData index_data);
+
+    // До count ближайших к center точек не дальше radius метров по поверхности: пары
+    // (номер точки, расстояние по дуге большого круга) в порядке возрастания расстояния
+    std::vector<std::pair<uint32_t, double>> FindNearest(Coordinates center, size_t count, double radius) const;
+    const IndexData& GetIndexData() const;
+
+private:
+    // Число узлов на каждом уровне для point_count точек
+    static std::vector<size_t> ComputeLevelSizes(size_t point_count);
+    void BuildBoxes();
+
+    // Единичные векторы точек в порядке листьев
+    std::vector<UnitVector> vectors_;
+    IndexData index_data_;
+    // Начало каждого уровня в index_data_.boxes
+    std::vector<size_t> level_offsets_;
+};
+
+}  // namespace geo
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+
+// Пул потоков для параллельных циклов вида ParallelFor.
+// Вызывающий поток тоже участвует в работе, поэтому пул на thread_count потоков
+// создаёт thread_count - 1 рабочих потоков.
+class ThreadPool {
+public:
+    // thread_count == 0 означает число аппаратных потоков
+    explicit ThreadPool(size_t thread_count) {
+        if (thread_count == 0) {
+            thread_count = std::max(1u, std::thread::hardware_concurrency());
+        }
+        workers_.reserve(thread_count - 1);
+        for (size_t i = 1; i < thread_count; ++i) {
+            workers_.emplace_back([this] { WorkerLoop(); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard lock(mutex_);
+            stopped_ = true;
+        }
+        job_started_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    size_t GetThreadCount() const {
+        return workers_.size() + 1;
+    }
+
+    // Вызывает func(index) для каждого index из [begin, end) и дожидается завершения.
+    // Первое выброшенное исключение пробрасывается в вызывающий поток.
+    template <typename Func>
+    void ParallelFor(size_t begin, size_t end, Func&& func) {
+        if (begin >= end) {
+            return;
+        }
+        if (workers_.empty() || end - begin == 1) {
+            for (size_t index = begin; index < end; ++index) {
+                func(index);
+            }
+            return;
+        }
+
+        std::atomic<size_t> next_index{ begin };
+        std::exception_ptr exception;
+        std::mutex exception_mutex;
+        auto job = [&] {
+            for (size_t index = next_index++; index < end; index = next_index++) {
+                try {
+                    func(index);
+                }
+                catch (...) {
+                    std::lock_guard lock(exception_mutex);
+                    if (!exception) {
+                        exception = std::current_exception();
+                    }
+                    next_index = end;
+                }
+            }
+        };
+
+        {
+            std::lock_guard lock(mutex_);
+            job_ = job;
+            busy_workers_ = workers_.size();
+            ++generation_;
+        }
+        job_started_.notify_all();
+        job();
+        {
+            std::unique_lock lock(mutex_);
+            job_finished_.wait(lock, [this] { return busy_workers_ == 0; });
+            job_ = nullptr;
+        }
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+
+private:
+    void WorkerLoop() {
+        size_t seen_generation = 0;
+        while (true) {
+            std::function<void()> job;
+            {
+                std::unique_lock lock(mutex_);
+                job_started_.wait(lock, [&] { return stopped_ || generation_ != seen_generation; });
+                if (stopped_) {
+                    return;
+                }
+                seen_generation = generation_;
+                job = job_;
+            }
+            job();
+            {
+                std::lock_guard lock(mutex_);
+                --busy_workers_;
+            }
+            job_finished_.notify_one();
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable job_started_;
+    std::condition_variable job_finished_;
+    std::function<void()> job_;
+    size_t generation_ = 0;
+    size_t busy_workers_ = 0;
+    bool stopped_ = false;
+};
+
+} // namespace parallel
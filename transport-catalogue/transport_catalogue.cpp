@@ -1,20 +1,154 @@
 #include "transport_catalogue.h"
 
+#include <algorithm>
+#include <tuple>
+#include <utility>
+
 namespace transport {
 
 void Catalogue::AddStop(std::string_view stop_name, const geo::Coordinates coordinates) {
-    all_stops_.push_back({ std::string(stop_name), coordinates, {} });
+    all_stops_.push_back({ static_cast<uint32_t>(all_stops_.size()), names_.Get(names_.Intern(stop_name)), coordinates, {} });
     stopname_to_stop_[all_stops_.back().name] = &all_stops_.back();
+    sorted_stops_[all_stops_.back().name] = &all_stops_.back();
+    stop_points_.Add(coordinates);
+}
+
+void Catalogue::AddRoute(std::string_view bus_number, std::vector<const Stop*> stops, bool is_circle) {
+    all_buses_.push_back({ static_cast<uint32_t>(all_buses_.size()), names_.Get(names_.Intern(bus_number)), std::move(stops), is_circle });
+    Bus& bus = all_buses_.back();
+    busname_to_bus_[bus.number] = &bus;
+    sorted_buses_[bus.number] = &bus;
+    for (const Stop* route_stop : bus.stops) {
+        all_stops_[route_stop->id].buses_by_stop.push_back(bus.number);
+    }
+}
+
+void Catalogue::Finalize() {
+    // Из повторно заданных расстояний остаётся последнее
+    std::stable_sort(stop_distances_.begin(), stop_distances_.end(), [](const StopDistance& lhs, const StopDistance& rhs) {
+        return std::tie(lhs.from, lhs.to) < std::tie(rhs.from, rhs.to);
+    });
+    std::vector<StopDistance> unique_distances;
+    unique_distances.reserve(stop_distances_.size());
+    for (const StopDistance& stop_distance : stop_distances_) {
+        if (!unique_distances.empty() && unique_distances.back().from == stop_distance.from
+            && unique_distances.back().to == stop_distance.to) {
+            unique_distances.back() = stop_distance;
+        }
+        else {
+            unique_distances.push_back(stop_distance);
+        }
+    }
+    stop_distances_ = std::move(unique_distances);
+
+    // Явное расстояние важнее обратного, поэтому при равных (from, to) оно идёт первым
+    struct DistanceCandidate {
+        uint32_t from;
+        uint32_t to;
+        bool is_reverse;
+        int distance;
+    };
+    std::vector<DistanceCandidate> candidates;
+    candidates.reserve(stop_distances_.size() * 2);
+    for (const auto& [from, to, distance] : stop_distances_) {
+        candidates.push_back({ from, to, false, distance });
+        candidates.push_back({ to, from, true, distance });
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const DistanceCandidate& lhs, const DistanceCandidate& rhs) {
+        return std::tie(lhs.from, lhs.to, lhs.is_reverse) < std::tie(rhs.from, rhs.to, rhs.is_reverse);
+    });
+    distance_offsets_.assign(all_stops_.size() + 1, 0);
+    distance_targets_.clear();
+    distance_values_.clear();
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        if (i > 0 && candidates[i].from == candidates[i - 1].from && candidates[i].to == candidates[i - 1].to) {
+            continue;
+        }
+        ++distance_offsets_[candidates[i].from + 1];
+        distance_targets_.push_back(candidates[i].to);
+        distance_values_.push_back(candidates[i].distance);
+    }
+    for (size_t stop = 0; stop < all_stops_.size(); ++stop) {
+        distance_offsets_[stop + 1] += distance_offsets_[stop];
+    }
+
+    // Географические длины перегонов всех маршрутов без статистики считаются одним пакетом
+    std::vector<uint32_t> segment_from;
+    std::vector<uint32_t> segment_to;
+    for (Bus& bus : all_buses_) {
+        bus.forward_distances.assign(bus.stops.size(), 0);
+        bus.backward_distances.assign(bus.stops.size(), 0);
+        for (size_t i = 1; i < bus.stops.size(); ++i) {
+            bus.forward_distances[i] = bus.forward_distances[i - 1] + GetDistance(bus.stops[i - 1], bus.stops[i]);
+            bus.backward_distances[i] = bus.backward_distances[i - 1] + GetDistance(bus.stops[i], bus.stops[i - 1]);
+            if (!bus.stat) {
+                segment_from.push_back(bus.stops[i - 1]->id);
+                segment_to.push_back(bus.stops[i]->id);
+            }
+        }
+    }
+    std::vector<double> segment_lengths;
+    geo::ComputeDistances(stop_points_, segment_from, segment_to, segment_lengths);
+    size_t segment = 0;
+    for (Bus& bus : all_buses_) {
+        if (bus.stat) {
+            continue;
+        }
+        double geographic_length = 0.0;
+        for (size_t i = 1; i < bus.stops.size(); ++i) {
+            geographic_length += segment_lengths[segment++];
+        }
+        bus.stat = ComputeBusStat(bus, geographic_length);
+    }
+
+    if (!stop_index_) {
+        stop_index_.emplace(stop_points_);
+    }
+
+    for (Stop& stop : all_stops_) {
+        auto& buses = stop.buses_by_stop;
+        std::sort(buses.begin(), buses.end());
+        buses.erase(std::unique(buses.begin(), buses.end()), buses.end());
+    }
 }
 
-void Catalogue::AddRoute(std::string_view bus_number, const std::vector<const Stop*> stops, bool is_circle) {
-    all_buses_.push_back({ std::string(bus_number), stops, is_circle });
-    busname_to_bus_[all_buses_.back().number] = &all_buses_.back();
-    for (const auto& route_stop : stops) {
-        for (auto& stop_ : all_stops_) {
-            if (stop_.name == route_stop->name) stop_.buses_by_stop.insert(std::string(bus_number));
+// Некольцевой маршрут проходится туда и обратно
+BusStat Catalogue::ComputeBusStat(const Bus& bus, double geographic_length) const {
+    BusStat bus_stat{};
+    bus_stat.stops_count = bus.is_circle ? bus.stops.size() : bus.stops.size() * 2 - 1;
+    bus_stat.unique_stops_count = UniqueStopsCount(bus.number);
+
+    int route_length = 0;
+    if (!bus.stops.empty()) {
+        route_length = bus.forward_distances.back();
+        if (!bus.is_circle) {
+            route_length += bus.backward_distances.back();
+            geographic_length *= 2;
         }
     }
+    bus_stat.route_length = route_length;
+    bus_stat.curvature = route_length / geographic_length;
+    return bus_stat;
+}
+
+void Catalogue::SetBusStat(std::string_view bus_number, const BusStat& bus_stat) {
+    all_buses_.at(busname_to_bus_.at(bus_number)->id).stat = bus_stat;
+}
+
+void Catalogue::SetStopIndex(geo::SpatialIndex::IndexData index_data) {
+    stop_index_.emplace(stop_points_, std::move(index_data));
+}
+
+const geo::SpatialIndex& Catalogue::GetStopIndex() const {
+    return stop_index_.value();
+}
+
+std::vector<std::pair<const Stop*, double>> Catalogue::FindNearestStops(geo::Coordinates center, size_t count, double radius) const {
+    std::vector<std::pair<const Stop*, double>> nearest_stops;
+    for (const auto& [stop_id, distance] : GetStopIndex().FindNearest(center, count, radius)) {
+        nearest_stops.emplace_back(&all_stops_[stop_id], distance);
+    }
+    return nearest_stops;
 }
 
 const Bus* Catalogue::FindRoute(std::string_view bus_number) const {
@@ -26,40 +160,52 @@ const Stop* Catalogue::FindStop(std::string_view stop_name) const {
 }
 
 size_t Catalogue::UniqueStopsCount(std::string_view bus_number) const {
-    std::unordered_set<std::string_view> unique_stops;
-    for (const auto& stop : busname_to_bus_.at(bus_number)->stops) {
-        unique_stops.insert(stop->name);
+    std::vector<uint32_t> unique_stops;
+    for (const Stop* stop : busname_to_bus_.at(bus_number)->stops) {
+        unique_stops.push_back(stop->id);
     }
-    return unique_stops.size();
+    std::sort(unique_stops.begin(), unique_stops.end());
+    return std::unique(unique_stops.begin(), unique_stops.end()) - unique_stops.begin();
 }
 
 void Catalogue::SetDistance(const Stop* from, const Stop* to, const int distance) {
-    stop_distances_[{from, to}] = distance;
+    stop_distances_.push_back({ from->id, to->id, distance });
 }
 
 int Catalogue::GetDistance(const Stop* from, const Stop* to) const {
-    if (stop_distances_.count({ from, to })) return stop_distances_.at({ from, to });
-    else if (stop_distances_.count({ to, from })) return stop_distances_.at({ to, from });
-    else return 0;
+    const auto targets_begin = distance_targets_.begin() + distance_offsets_.at(from->id);
+    const auto targets_end = distance_targets_.begin() + distance_offsets_.at(from->id + 1);
+    const auto it = std::lower_bound(targets_begin, targets_end, to->id);
+    if (it == targets_end || *it != to->id) return 0;
+    return distance_values_[it - distance_targets_.begin()];
 }
 
-const std::map<std::string_view, const Bus*> Catalogue::GetSortedAllBuses() const {
-    std::map<std::string_view, const Bus*> result;
-    for (const auto& bus : busname_to_bus_) {
-        result.emplace(bus);
-    }
-    return result;
+int Catalogue::GetRouteDistance(const Bus* bus, size_t from_index, size_t to_index) const {
+    if (from_index <= to_index) return bus->forward_distances.at(to_index) - bus->forward_distances.at(from_index);
+    else return bus->backward_distances.at(from_index) - bus->backward_distances.at(to_index);
 }
 
-const std::map<std::string_view, const Stop*> Catalogue::GetSortedAllStops() const {
-    std::map<std::string_view, const Stop*> result;
-    for (const auto& stop : stopname_to_stop_) {
-        result.emplace(stop);
-    }
-    return result;
+const std::map<std::string_view, const Bus*>& Catalogue::GetSortedAllBuses() const {
+    return sorted_buses_;
+}
+
+const std::map<std::string_view, const Stop*>& Catalogue::GetSortedAllStops() const {
+    return sorted_stops_;
+}
+
+const Stop& Catalogue::GetStop(uint32_t stop_id) const {
+    return all_stops_.at(stop_id);
+}
+
+size_t Catalogue::GetStopCount() const {
+    return all_stops_.size();
+}
+
+const NameArena& Catalogue::GetNames() const {
+    return names_;
 }
 
-const std::unordered_map<std::pair<const Stop*, const Stop*>, int, Catalogue::StopDistancesHasher> Catalogue::GetStopDistances() const {
+const std::vector<StopDistance>& Catalogue::GetStopDistances() const {
     return stop_distances_;
 }
 }  // namespace transport
\ No newline at end of file
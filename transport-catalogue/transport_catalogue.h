@@ -2,7 +2,10 @@
 
 #include "geo.h"
 #include "domain.h"
+#include "name_arena.h"
+#include "spatial_index.h"
 
+#include <cstdint>
 #include <iostream>
 #include <deque>
 #include <string>
@@ -11,38 +14,72 @@
 #include <stdexcept>
 #include <optional>
 #include <unordered_set>
-#include <set>
 #include <map>
 
 namespace transport {
 
+// Дорожное расстояние, заданное явно, между остановками с номерами from и to
+struct StopDistance {
+    uint32_t from;
+    uint32_t to;
+    int distance;
+};
+
 class Catalogue {
 public:
-    struct StopDistancesHasher {
-        size_t operator()(const std::pair<const Stop*, const Stop*>& points) const {
-            size_t hash_first = std::hash<const void*>{}(points.first);
-            size_t hash_second = std::hash<const void*>{}(points.second);
-            return hash_first + hash_second * 37;
-        }
-    };
-
     void AddStop(std::string_view stop_name, const geo::Coordinates coordinates);
-    void AddRoute(std::string_view bus_number, const std::vector<const Stop*> stops, bool is_circle);
+    void AddRoute(std::string_view bus_number, std::vector<const Stop*> stops, bool is_circle);
+    // Завершает загрузку: строит таблицу расстояний, считает длины маршрутов и сортирует автобусы
+    // каждой остановки. Вызывается после добавления всех остановок, расстояний и маршрутов;
+    // расстояния и длины маршрутов доступны только после него
+    void Finalize();
+    // Задаёт готовую статистику маршрута, чтобы Finalize не пересчитывал её
+    void SetBusStat(std::string_view bus_number, const BusStat& bus_stat);
+    // Задаёт готовый пространственный индекс остановок, чтобы Finalize не строил его.
+    // Вызывается после добавления всех остановок
+    void SetStopIndex(geo::SpatialIndex::IndexData index_data);
+    // Индекс остановок по номерам, строится в Finalize
+    const geo::SpatialIndex& GetStopIndex() const;
+    // До count ближайших к center остановок не дальше radius метров по поверхности Земли,
+    // в порядке возрастания расстояния
+    std::vector<std::pair<const Stop*, double>> FindNearestStops(geo::Coordinates center, size_t count, double radius) const;
     const Bus* FindRoute(std::string_view bus_number) const;
     const Stop* FindStop(std::string_view stop_name) const;
     size_t UniqueStopsCount(std::string_view bus_number) const;
     void SetDistance(const Stop* from, const Stop* to, const int distance);
     int GetDistance(const Stop* from, const Stop* to) const;
-    const std::map<std::string_view, const Bus*> GetSortedAllBuses() const;
-    const std::map<std::string_view, const Stop*> GetSortedAllStops() const;
-    const std::unordered_map<std::pair<const Stop*, const Stop*>, int, StopDistancesHasher> GetStopDistances() const;
+    int GetRouteDistance(const Bus* bus, size_t from_index, size_t to_index) const;
+    const std::map<std::string_view, const Bus*>& GetSortedAllBuses() const;
+    const std::map<std::string_view, const Stop*>& GetSortedAllStops() const;
+    const Stop& GetStop(uint32_t stop_id) const;
+    size_t GetStopCount() const;
+    // Все названия остановок и номера автобусов каталога
+    const NameArena& GetNames() const;
+    // Явно заданные расстояния; после Finalize без повторов, упорядочены по (from, to)
+    const std::vector<StopDistance>& GetStopDistances() const;
 
 private:
+    // geographic_length - сумма географических длин перегонов в одном направлении
+    BusStat ComputeBusStat(const Bus& bus, double geographic_length) const;
+
+    NameArena names_;
     std::deque<Bus> all_buses_;
     std::deque<Stop> all_stops_;
     std::unordered_map<std::string_view, const Bus*> busname_to_bus_;
     std::unordered_map<std::string_view, const Stop*> stopname_to_stop_;
-    std::unordered_map<std::pair<const Stop*, const Stop*>, int, StopDistancesHasher> stop_distances_;
+    // Те же указатели в порядке названий, для обхода без пересортировки
+    std::map<std::string_view, const Bus*> sorted_buses_;
+    std::map<std::string_view, const Stop*> sorted_stops_;
+    std::vector<StopDistance> stop_distances_;
+    // Координаты остановок по номерам с предвычисленной тригонометрией широты
+    geo::PointArrays stop_points_;
+    std::optional<geo::SpatialIndex> stop_index_;
+    // Расстояния в формате CSR: из остановки s - distance_targets_ и distance_values_
+    // в [distance_offsets_[s], distance_offsets_[s + 1]), по возрастанию номера остановки.
+    // Расстояние, заданное только в обратную сторону, подставляется при построении
+    std::vector<size_t> distance_offsets_;
+    std::vector<uint32_t> distance_targets_;
+    std::vector<int> distance_values_;
 };
 
 }  // namespace transport
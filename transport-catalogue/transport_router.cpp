@@ -1,95 +1,646 @@
 #include "transport_router.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+
 namespace transport {
 
-const graph::DirectedWeightedGraph<double>& Router::BuildGraph(const Catalogue& catalogue) {
+namespace {
+
+// Число единиц веса fixed в одной минуте
+constexpr double FIXED_WEIGHT_SCALE = 1000.0;
+
+// Нижняя оценка времени в единицах веса: целый вес округляется вниз,
+// чтобы оценка A* оставалась допустимой и согласованной
+RouteWeight ToRouteWeightLowerBound(double minutes) {
+    if constexpr (std::is_integral_v<RouteWeight>) {
+        return static_cast<RouteWeight>(std::floor(minutes * FIXED_WEIGHT_SCALE));
+    }
+    else {
+        return static_cast<RouteWeight>(minutes);
+    }
+}
+
+} // namespace
+
+RouteWeight ToRouteWeight(double minutes) {
+    if constexpr (std::is_integral_v<RouteWeight>) {
+        return static_cast<RouteWeight>(std::llround(minutes * FIXED_WEIGHT_SCALE));
+    }
+    else {
+        return static_cast<RouteWeight>(minutes);
+    }
+}
+
+double ToMinutes(RouteWeight weight) {
+    if constexpr (std::is_integral_v<RouteWeight>) {
+        return static_cast<double>(weight) / FIXED_WEIGHT_SCALE;
+    }
+    else {
+        return static_cast<double>(weight);
+    }
+}
+
+const graph::DirectedWeightedGraph<RouteWeight>& Router::BuildGraph(const Catalogue& catalogue) {
     const auto& all_stops = catalogue.GetSortedAllStops();
     const auto& all_buses = catalogue.GetSortedAllBuses();
-    graph::DirectedWeightedGraph<double> stops_graph(all_stops.size() * 2);
-    std::map<std::string, graph::VertexId> stop_ids;
+
+    // Движку RAPTOR рёбра автобусов не нужны: в графе остаются только остановки
+    const bool has_bus_edges = settings_.engine != RouterEngine::RAPTOR;
+    const bool is_linear = has_bus_edges && settings_.graph_model == GraphModel::LINEAR;
+    size_t vertex_count = all_stops.size() * 2;
+    if (is_linear) {
+        for (const auto& [bus_number, bus_info] : all_buses) {
+            vertex_count += GetRideVertexCount(*bus_info);
+        }
+    }
+    graph::DirectedWeightedGraph<RouteWeight> stops_graph(vertex_count);
     graph::VertexId vertex_id = 0;
+    // Таблица имён рёбер: сначала остановки, затем автобусы
+    names_.clear();
+    names_.reserve(all_stops.size() + all_buses.size());
 
     for (const auto& [stop_name, stop_info] : all_stops) {
-        stop_ids[stop_info->name] = vertex_id;
         stops_graph.AddEdge({
-                stop_info->name,
+                AddName(stop_info->name),
                 0,
                 vertex_id,
                 ++vertex_id,
-                static_cast<double>(bus_wait_time_)
+                ToRouteWeight(settings_.bus_wait_time)
             });
         ++vertex_id;
     }
-    stop_ids_ = std::move(stop_ids);
 
-    for_each(
-        all_buses.begin(),
-        all_buses.end(),
-        [&stops_graph, this, &catalogue](const auto& item) {
-            const auto& bus_info = item.second;
-            const auto& stops = bus_info->stops;
-            size_t stops_count = stops.size();
+    // Рёбра автобусов независимы: каждый автобус заполняет свой буфер (параллельно, если задан пул потоков),
+    // затем буферы сливаются в порядке автобусов, поэтому номера рёбер не зависят от числа потоков
+    std::vector<const Bus*> buses;
+    std::vector<uint32_t> bus_name_ids;
+    std::vector<graph::VertexId> first_ride_vertices;
+    buses.reserve(all_buses.size());
+    bus_name_ids.reserve(all_buses.size());
+    first_ride_vertices.reserve(all_buses.size());
+    for (const auto& [bus_number, bus_info] : all_buses) {
+        buses.push_back(bus_info);
+        bus_name_ids.push_back(AddName(bus_info->number));
+        first_ride_vertices.push_back(vertex_id);
+        if (is_linear) {
+            vertex_id += GetRideVertexCount(*bus_info);
+        }
+    }
+    IndexStopIds(all_stops.size());
+    if (!has_bus_edges) {
+        FillRaptorData(catalogue, buses, bus_name_ids);
+        buses.clear();
+    }
+
+    std::vector<std::vector<graph::Edge<RouteWeight>>> bus_edges(buses.size());
+    const auto fill_bus_edges = [&](size_t bus_index) {
+        if (is_linear) {
+            AddBusRideEdges(bus_edges[bus_index], catalogue, *buses[bus_index], bus_name_ids[bus_index], first_ride_vertices[bus_index]);
+        }
+        else {
+            AddBusEdges(bus_edges[bus_index], catalogue, *buses[bus_index], bus_name_ids[bus_index]);
+        }
+    };
+    if (auto* thread_pool = GetThreadPool()) {
+        thread_pool->ParallelFor(0, buses.size(), fill_bus_edges);
+    }
+    else {
+        for (size_t bus_index = 0; bus_index < buses.size(); ++bus_index) {
+            fill_bus_edges(bus_index);
+        }
+    }
+
+    for (auto& edges : bus_edges) {
+        for (const auto& edge : edges) {
+            stops_graph.AddEdge(edge);
+        }
+        std::vector<graph::Edge<RouteWeight>>().swap(edges);
+    }
+    graph_ = std::move(stops_graph);
+    InitializeRouter([&] {
+        FillGeoBoundData(catalogue, buses, first_ride_vertices, is_linear, vertex_count);
+    });
+
+    return graph_;
+}
+
+void Router::AddBusEdges(std::vector<graph::Edge<RouteWeight>>& edges, const Catalogue& catalogue, const Bus& bus_info,
+    uint32_t name_id) const {
+    const auto& stops = bus_info.stops;
+    size_t stops_count = stops.size();
+    for (size_t i = 0; i < stops_count; ++i) {
+        for (size_t j = i + 1; j < stops_count; ++j) {
+            const Stop* stop_from = stops[i];
+            const Stop* stop_to = stops[j];
+            const int dist_sum = catalogue.GetRouteDistance(&bus_info, i, j);
+            const int dist_sum_inverse = catalogue.GetRouteDistance(&bus_info, j, i);
+            edges.push_back({ name_id,
+                              j - i,
+                              stop_ids_.at(stop_from->name) + 1,
+                              stop_ids_.at(stop_to->name),
+                              ToRouteWeight(ComputeRideTime(dist_sum)) });
+
+            if (!bus_info.is_circle) {
+                edges.push_back({ name_id,
+                                  j - i,
+                                  stop_ids_.at(stop_to->name) + 1,
+                                  stop_ids_.at(stop_from->name),
+                                  ToRouteWeight(ComputeRideTime(dist_sum_inverse)) });
+            }
+        }
+    }
+}
+
+// Вершина "в автобусе" заводится для каждой промежуточной остановки каждого направления.
+// Из вершины выхода остановки и из вершины "в автобусе" на предыдущей остановке
+// рёбра ведут на один перегон: в вершину входа следующей остановки (выйти)
+// и в вершину "в автобусе" на ней (ехать дальше)
+void Router::AddBusRideEdges(std::vector<graph::Edge<RouteWeight>>& edges, const Catalogue& catalogue, const Bus& bus_info,
+    uint32_t name_id, graph::VertexId first_ride_vertex) const {
+    const auto& stops = bus_info.stops;
+    const size_t stops_count = stops.size();
+    const size_t direction_count = bus_info.is_circle ? 1 : 2;
+    for (size_t direction = 0; direction < direction_count; ++direction) {
+        // Позиция i-й по ходу движения остановки в bus_info.stops
+        const auto position = [direction, stops_count](size_t i) { return direction == 0 ? i : stops_count - 1 - i; };
+        // Вершина "в автобусе" на i-й остановке (0 < i < stops_count - 1)
+        const auto ride_vertex = [first_ride_vertex](size_t i) { return first_ride_vertex + i - 1; };
+        for (size_t i = 0; i + 1 < stops_count; ++i) {
+            const RouteWeight ride_time = ToRouteWeight(ComputeRideTime(catalogue.GetRouteDistance(&bus_info, position(i), position(i + 1))));
+            const graph::VertexId stop_out = stop_ids_.at(stops[position(i)]->name) + 1;
+            const graph::VertexId next_stop_in = stop_ids_.at(stops[position(i + 1)]->name);
+            const bool has_next_ride_vertex = i + 2 < stops_count;
+
+            edges.push_back({ name_id, 1, stop_out, next_stop_in, ride_time });
+            if (has_next_ride_vertex) {
+                edges.push_back({ name_id, 1, stop_out, ride_vertex(i + 1), ride_time });
+            }
+            if (i > 0) {
+                edges.push_back({ name_id, 1, ride_vertex(i), next_stop_in, ride_time });
+                if (has_next_ride_vertex) {
+                    edges.push_back({ name_id, 1, ride_vertex(i), ride_vertex(i + 1), ride_time });
+                }
+            }
+        }
+        first_ride_vertex += stops_count > 2 ? stops_count - 2 : 0;
+    }
+}
+
+// Каждое направление автобуса - отдельный маршрут RAPTOR; номера остановок совпадают с их номерами в таблице имён
+void Router::FillRaptorData(const Catalogue& catalogue, const std::vector<const Bus*>& buses, const std::vector<uint32_t>& bus_name_ids) {
+    RaptorData raptor_data;
+    raptor_data.stop_count = stop_ids_.size();
+    for (size_t bus_index = 0; bus_index < buses.size(); ++bus_index) {
+        const Bus& bus_info = *buses[bus_index];
+        const size_t stops_count = bus_info.stops.size();
+        const size_t direction_count = bus_info.is_circle ? 1 : 2;
+        for (size_t direction = 0; direction < direction_count; ++direction) {
+            const auto position = [direction, stops_count](size_t i) { return direction == 0 ? i : stops_count - 1 - i; };
+            RaptorRoute& route = raptor_data.routes.emplace_back();
+            route.name_id = bus_name_ids[bus_index];
+            route.stops.reserve(stops_count);
+            route.distances.reserve(stops_count);
             for (size_t i = 0; i < stops_count; ++i) {
-                for (size_t j = i + 1; j < stops_count; ++j) {
-                    const Stop* stop_from = stops[i];
-                    const Stop* stop_to = stops[j];
-                    int dist_sum = 0;
-                    int dist_sum_inverse = 0;
-                    for (size_t k = i + 1; k <= j; ++k) {
-                        dist_sum += catalogue.GetDistance(stops[k - 1], stops[k]);
-                        dist_sum_inverse += catalogue.GetDistance(stops[k], stops[k - 1]);
-                    }
-                    stops_graph.AddEdge({ bus_info->number,
-                                          j - i,
-                                          stop_ids_.at(stop_from->name) + 1,
-                                          stop_ids_.at(stop_to->name),
-                                          static_cast<double>(dist_sum) / (bus_velocity_ * (100.0 / 6.0))});
-
-                    if (!bus_info->is_circle) {
-                        stops_graph.AddEdge({ bus_info->number,
-                                              j - i,
-                                              stop_ids_.at(stop_to->name) + 1,
-                                              stop_ids_.at(stop_from->name),
-                                              static_cast<double>(dist_sum_inverse) / (bus_velocity_ * (100.0 / 6.0))});
-                    }
+                route.stops.push_back(static_cast<uint32_t>(stop_ids_.at(bus_info.stops[position(i)]->name) / 2));
+                route.distances.push_back(catalogue.GetRouteDistance(&bus_info, position(0), position(i)));
+            }
+        }
+    }
+    raptor_data_ = std::move(raptor_data);
+}
+
+// time_per_meter - наименьшее отношение веса ребра автобуса к хорде между его концами, поэтому
+// по неравенству треугольника оценка time_per_meter * хорда до цели допустима и согласована.
+// Отношение считается по уже округлённым весам рёбер, запас поглощает ошибки округления оценки
+void Router::FillGeoBoundData(const Catalogue& catalogue, const std::vector<const Bus*>& buses,
+    const std::vector<graph::VertexId>& first_ride_vertices, bool is_linear, size_t vertex_count) {
+    GeoBoundData geo_bound_data;
+    std::vector<geo::UnitVector> stop_points;
+    for (const auto& [stop_name, stop_info] : catalogue.GetSortedAllStops()) {
+        geo_bound_data.stop_coordinates.push_back(stop_info->coordinates);
+        stop_points.push_back(geo::ToUnitVector(stop_info->coordinates));
+    }
+    geo_bound_data.vertex_stops.assign(vertex_count, 0);
+    for (size_t stop = 0; stop < stop_points.size(); ++stop) {
+        geo_bound_data.vertex_stops[2 * stop] = static_cast<uint32_t>(stop);
+        geo_bound_data.vertex_stops[2 * stop + 1] = static_cast<uint32_t>(stop);
+    }
+
+    // Вершина "в автобусе" относится к своей остановке
+    for (size_t bus_index = 0; is_linear && bus_index < buses.size(); ++bus_index) {
+        const Bus& bus_info = *buses[bus_index];
+        const size_t stops_count = bus_info.stops.size();
+        const size_t direction_count = bus_info.is_circle ? 1 : 2;
+        const auto stop_index = [&](size_t position) { return GetStopIndex(stop_ids_.at(bus_info.stops[position]->name)); };
+        for (size_t direction = 0; direction < direction_count; ++direction) {
+            const auto position = [direction, stops_count](size_t i) { return direction == 0 ? i : stops_count - 1 - i; };
+            for (size_t i = 1; i + 1 < stops_count; ++i) {
+                geo_bound_data.vertex_stops[first_ride_vertices[bus_index] + direction * (stops_count - 2) + i - 1]
+                    = stop_index(position(i));
+            }
+        }
+    }
+
+    double time_per_meter = std::numeric_limits<double>::infinity();
+    for (graph::EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+        const auto& edge = graph_.GetEdge(edge_id);
+        const double chord = geo::ComputeChordDistance(stop_points[geo_bound_data.vertex_stops[edge.from]],
+            stop_points[geo_bound_data.vertex_stops[edge.to]]);
+        if (edge.quality > 0 && chord > 0.0) {
+            time_per_meter = std::min(time_per_meter, ToMinutes(edge.weight) / chord);
+        }
+    }
+    const double margin = std::max(1e-9, 8.0 * std::numeric_limits<RouteWeight>::epsilon());
+    geo_bound_data.time_per_meter = std::isinf(time_per_meter) ? 0.0 : time_per_meter * (1.0 - margin);
+    geo_bound_data_ = std::move(geo_bound_data);
+}
+
+size_t Router::GetRideVertexCount(const Bus& bus_info) const {
+    const size_t stops_count = bus_info.stops.size();
+    const size_t direction_count = bus_info.is_circle ? 1 : 2;
+    return stops_count > 2 ? (stops_count - 2) * direction_count : 0;
+}
+
+double Router::ComputeRideTime(int distance) const {
+    return static_cast<double>(distance) / (settings_.bus_velocity * (100.0 / 6.0));
+}
+
+const std::optional<RouteInfo> Router::FindRoute(const std::string_view stop_from, const std::string_view stop_to) const {
+    const graph::VertexId from = stop_ids_.at(stop_from);
+    const graph::VertexId to = stop_ids_.at(stop_to);
+    const uint64_t cache_key = (static_cast<uint64_t>(from) << 32) | static_cast<uint64_t>(to);
+    if (route_cache_) {
+        if (auto cached_route = route_cache_->Get(cache_key)) {
+            return std::move(*cached_route);
+        }
+    }
+
+    std::optional<graph::Router<RouteWeight>::RouteInfo> graph_route;
+    std::optional<RouteInfo> route;
+    switch (settings_.engine) {
+        case RouterEngine::RAPTOR:
+            route = raptor_router_->BuildRoute(GetStopIndex(from), GetStopIndex(to));
+            break;
+        case RouterEngine::DIJKSTRA:
+            graph_route = FindDijkstraRoute(from, to);
+            break;
+        case RouterEngine::CONTRACTION_HIERARCHIES:
+            graph_route = contraction_hierarchy_->BuildRoute(from, to);
+            break;
+        case RouterEngine::PRECOMPUTED:
+        default:
+            graph_route = router_->BuildRoute(from, to);
+            break;
+    }
+    if (graph_route) {
+        route = MakeRouteInfo(*graph_route);
+    }
+    if (route_cache_) {
+        route_cache_->Put(cache_key, route);
+    }
+    return route;
+}
+
+std::optional<std::vector<std::pair<uint32_t, double>>> Router::FindReachableStops(const std::string_view stop_from,
+    double max_time) const {
+    const auto from_it = stop_ids_.find(stop_from);
+    if (from_it == stop_ids_.end()) {
+        return std::nullopt;
+    }
+    const graph::VertexId from = from_it->second;
+    std::vector<std::pair<uint32_t, double>> reachable_stops;
+    if (settings_.engine == RouterEngine::RAPTOR) {
+        const auto times = raptor_router_->BuildTimes(GetStopIndex(from));
+        for (uint32_t stop = 0; stop < times.size(); ++stop) {
+            if (times[stop] && *times[stop] <= max_time) {
+                reachable_stops.emplace_back(stop, *times[stop]);
+            }
+        }
+    }
+    else {
+        // Время прибытия на остановку - вес пути до её вершины входа с чётным номером
+        const graph::VertexId stop_vertex_end = 2 * stop_ids_.size();
+        const RouteWeight max_weight = ToRouteWeight(std::min(max_time, ToMinutes(graph::GetUnreachableWeight<RouteWeight>())));
+        for (const auto& [vertex, weight] : dijkstra_router_->BuildReachable(from, max_weight)) {
+            if (vertex < stop_vertex_end && vertex % 2 == 0) {
+                reachable_stops.emplace_back(GetStopIndex(vertex), ToMinutes(weight));
+            }
+        }
+    }
+    std::sort(reachable_stops.begin(), reachable_stops.end(), [](const auto& lhs, const auto& rhs) {
+        return std::tie(lhs.second, lhs.first) < std::tie(rhs.second, rhs.first);
+    });
+    return reachable_stops;
+}
+
+std::optional<graph::Router<RouteWeight>::RouteInfo> Router::FindDijkstraRoute(graph::VertexId from, graph::VertexId to) const {
+    switch (settings_.search_heuristic) {
+        case SearchHeuristic::A_STAR: {
+            const auto& vertex_stops = geo_bound_data_->vertex_stops;
+            const geo::UnitVector& target_point = stop_points_[vertex_stops[to]];
+            const double time_per_meter = geo_bound_data_->time_per_meter;
+            return dijkstra_router_->BuildRoute(from, to, [&](graph::VertexId vertex) {
+                return ToRouteWeightLowerBound(time_per_meter * geo::ComputeChordDistance(stop_points_[vertex_stops[vertex]], target_point));
+            });
+        }
+        case SearchHeuristic::ALT:
+            return dijkstra_router_->BuildRoute(from, to, [this, to](graph::VertexId vertex) {
+                return landmarks_->GetLowerBound(vertex, to);
+            });
+        case SearchHeuristic::NONE:
+        default:
+            return dijkstra_router_->BuildRoute(from, to);
+    }
+}
+
+// Поездка на одном автобусе может состоять из нескольких рёбер подряд
+// (модель графа linear), они объединяются в один элемент BUS
+RouteInfo Router::MakeRouteInfo(const graph::Router<RouteWeight>::RouteInfo& graph_route) const {
+    RouteInfo route_info;
+    route_info.items.reserve(graph_route.edges.size());
+    bool is_bus_ride = false;
+    for (const graph::EdgeId edge_id : graph_route.edges) {
+        const graph::Edge<RouteWeight>& edge = graph_.GetEdge(edge_id);
+        const double time = ToMinutes(edge.weight);
+        if (edge.quality == 0) {
+            route_info.items.push_back({ RouteItem::Type::WAIT, edge.name_id, 0, time });
+            is_bus_ride = false;
+        }
+        else if (is_bus_ride) {
+            route_info.items.back().span_count += edge.quality;
+            route_info.items.back().time += time;
+        }
+        else {
+            route_info.items.push_back({ RouteItem::Type::BUS, edge.name_id, edge.quality, time });
+            is_bus_ride = true;
+        }
+        route_info.total_time += time;
+    }
+    return route_info;
+}
+
+std::optional<std::vector<std::vector<std::optional<double>>>> Router::FindRouteMatrix(
+    const std::vector<std::string_view>& stops_from, const std::vector<std::string_view>& stops_to) const {
+    const auto to_vertices = [this](const std::vector<std::string_view>& stops, std::vector<graph::VertexId>& vertices) {
+        vertices.reserve(stops.size());
+        for (const std::string_view stop : stops) {
+            const auto it = stop_ids_.find(stop);
+            if (it == stop_ids_.end()) {
+                return false;
+            }
+            vertices.push_back(it->second);
+        }
+        return true;
+    };
+    std::vector<graph::VertexId> sources;
+    std::vector<graph::VertexId> targets;
+    if (!to_vertices(stops_from, sources) || !to_vertices(stops_to, targets)) {
+        return std::nullopt;
+    }
+    std::vector<std::vector<std::optional<RouteWeight>>> weights;
+    switch (settings_.engine) {
+        case RouterEngine::RAPTOR: {
+            std::vector<std::vector<std::optional<double>>> matrix;
+            matrix.reserve(sources.size());
+            for (const graph::VertexId from : sources) {
+                const auto times = raptor_router_->BuildTimes(GetStopIndex(from));
+                auto& row = matrix.emplace_back();
+                row.reserve(targets.size());
+                for (const graph::VertexId to : targets) {
+                    row.push_back(times[GetStopIndex(to)]);
                 }
             }
-        });
+            return matrix;
+        }
+        case RouterEngine::DIJKSTRA:
+            weights = dijkstra_router_->BuildWeightMatrix(sources, targets);
+            break;
+        case RouterEngine::CONTRACTION_HIERARCHIES:
+            weights = contraction_hierarchy_->BuildWeightMatrix(sources, targets);
+            break;
+        case RouterEngine::PRECOMPUTED:
+        default:
+            weights = router_->BuildWeightMatrix(sources, targets);
+            break;
+    }
 
-    graph_ = std::move(stops_graph);
-    router_ = std::make_unique<graph::Router<double>>(graph_);
+    std::vector<std::vector<std::optional<double>>> matrix;
+    matrix.reserve(weights.size());
+    for (const auto& weights_row : weights) {
+        auto& row = matrix.emplace_back();
+        row.reserve(weights_row.size());
+        for (const auto& weight : weights_row) {
+            row.push_back(weight ? std::optional<double>(ToMinutes(*weight)) : std::nullopt);
+        }
+    }
+    return matrix;
+}
 
+const graph::DirectedWeightedGraph<RouteWeight>& Router::GetGraph() const {
     return graph_;
 }
 
-const std::optional<graph::Router<double>::RouteInfo> Router::FindRoute(const std::string_view stop_from, const std::string_view stop_to) const {
-    return router_->BuildRoute(stop_ids_.at(std::string(stop_from)),stop_ids_.at(std::string(stop_to)));
+void Router::SetGraph(graph::DirectedWeightedGraph<RouteWeight> graph, size_t stop_count) {
+    graph_ = std::move(graph);
+    IndexStopIds(stop_count);
+    InitializeRouter();
 }
 
-const graph::DirectedWeightedGraph<double>& Router::GetGraph() const {
-    return graph_;
+void Router::SetRoutesTable(graph::Router<RouteWeight>::RoutesTable routes_table) {
+    routes_table_ = std::move(routes_table);
+}
+
+const graph::Router<RouteWeight>::RoutesTable* Router::GetRoutesTable() const {
+    return router_ ? &router_->GetRoutesTable() : nullptr;
+}
+
+void Router::SetHierarchyData(graph::ContractionHierarchy<RouteWeight>::HierarchyData hierarchy_data) {
+    hierarchy_data_ = std::move(hierarchy_data);
+}
+
+const graph::ContractionHierarchy<RouteWeight>::HierarchyData* Router::GetHierarchyData() const {
+    return contraction_hierarchy_ ? &contraction_hierarchy_->GetHierarchyData() : nullptr;
+}
+
+void Router::SetRaptorData(RaptorData raptor_data) {
+    raptor_data_ = std::move(raptor_data);
+}
+
+const RaptorData* Router::GetRaptorData() const {
+    return raptor_router_ ? &raptor_router_->GetRaptorData() : nullptr;
+}
+
+// Вершина входа остановки имеет номер 2 * i, где i - номер остановки в таблице имён
+uint32_t Router::GetStopIndex(graph::VertexId vertex) {
+    return static_cast<uint32_t>(vertex / 2);
+}
+
+void Router::SetGeoBoundData(GeoBoundData geo_bound_data) {
+    geo_bound_data_ = std::move(geo_bound_data);
+}
+
+const GeoBoundData* Router::GetGeoBoundData() const {
+    return geo_bound_data_ ? &*geo_bound_data_ : nullptr;
 }
 
-void Router::SetGraph(const graph::DirectedWeightedGraph<double> graph, const std::map<std::string, graph::VertexId> stop_ids) {
-    graph_ = graph;
-    stop_ids_ = stop_ids;
-    router_ = std::make_unique<graph::Router<double>>(graph_);
+void Router::SetLandmarkData(graph::Landmarks<RouteWeight>::LandmarkData landmark_data) {
+    landmark_data_ = std::move(landmark_data);
+}
+
+const graph::Landmarks<RouteWeight>::LandmarkData* Router::GetLandmarkData() const {
+    return landmarks_ ? &landmarks_->GetLandmarkData() : nullptr;
+}
+
+std::string_view Router::GetName(uint32_t name_id) const {
+    return names_.at(name_id);
+}
+
+const std::vector<std::string_view>& Router::GetNames() const {
+    return names_;
+}
+
+void Router::SetNames(std::vector<std::string_view> names) {
+    const size_t stop_count = stop_ids_.size();
+    names_ = std::move(names);
+    IndexStopIds(stop_count);
+}
+
+uint32_t Router::AddName(std::string_view name) {
+    names_.push_back(name);
+    return static_cast<uint32_t>(names_.size() - 1);
 }
 
 const int Router::GetBusWaitTime() const {
-    return bus_wait_time_;
+    return settings_.bus_wait_time;
 }
 
 const double Router::GetBusVelocity() const {
-    return bus_velocity_;
+    return settings_.bus_velocity;
 }
 
-const Router Router::GetRouterSettings() const {
-    return { bus_wait_time_, bus_velocity_ };
+const RoutingSettings& Router::GetRoutingSettings() const {
+    return settings_;
 }
 
-const std::map<std::string, graph::VertexId> Router::GetStopIds() const {
+const Router::StopIds& Router::GetStopIds() const {
     return stop_ids_;
 }
 
+// Индекс перестраивается при каждой замене таблицы имён
+void Router::IndexStopIds(size_t stop_count) {
+    if (stop_count > names_.size()) {
+        throw std::invalid_argument("Stop names are missing");
+    }
+    stop_ids_.clear();
+    stop_ids_.reserve(stop_count);
+    for (size_t stop = 0; stop < stop_count; ++stop) {
+        stop_ids_.emplace(names_[stop], 2 * stop);
+    }
+}
+
+// Таблица маршрутов занимает V x V ячеек и строится за O(V^3), поиск Дейкстры стоит O((V + E) log V)
+// на запрос. Таблица выбирается, если помещается в бюджет памяти и её построение окупается
+// ожидаемым числом запросов; иначе при большом числе запросов строится иерархия сжатия,
+// построение которой сопоставимо с несколькими десятками поисков Дейкстры.
+// Если число запросов не задано, считается, что маршрут запросят по разу от каждой остановки
+RouterEngine Router::SelectEngine() const {
+    constexpr double HIERARCHY_BUILD_SEARCHES = 50.0;
+    const double vertex_count = static_cast<double>(graph_.GetVertexCount());
+    const double edge_count = static_cast<double>(graph_.GetEdgeCount());
+    const double table_bytes = vertex_count * vertex_count * (sizeof(RouteWeight) + sizeof(uint32_t));
+    const bool table_fits = table_bytes <= static_cast<double>(settings_.memory_budget);
+
+    const double queries = settings_.expected_queries > 0 ? static_cast<double>(settings_.expected_queries)
+        : static_cast<double>(stop_ids_.size());
+    const double search_cost = (vertex_count + edge_count) * std::log2(vertex_count + 2.0);
+    if (table_fits && vertex_count * vertex_count * vertex_count <= queries * search_cost) {
+        return RouterEngine::PRECOMPUTED;
+    }
+    if (queries > HIERARCHY_BUILD_SEARCHES) {
+        return RouterEngine::CONTRACTION_HIERARCHIES;
+    }
+    return RouterEngine::DIJKSTRA;
+}
+
+// AUTO заменяется выбранным движком только здесь. Данные оценки A* нужны лишь движку dijkstra,
+// поэтому fill_geo_bound_data вызывается после выбора движка
+void Router::InitializeRouter(const std::function<void()>& fill_geo_bound_data) {
+    if (settings_.engine == RouterEngine::AUTO) {
+        settings_.engine = SelectEngine();
+    }
+    if (fill_geo_bound_data && settings_.engine == RouterEngine::DIJKSTRA
+        && settings_.search_heuristic == SearchHeuristic::A_STAR) {
+        fill_geo_bound_data();
+    }
+    // Поисковые движки обходят граф в формате CSR
+    graph_.Freeze();
+    router_.reset();
+    dijkstra_router_.reset();
+    contraction_hierarchy_.reset();
+    raptor_router_.reset();
+    landmarks_.reset();
+    stop_points_.clear();
+    // Поиск Дейкстры нужен и остальным движкам на графе: через него выполняются запросы от одной остановки ко всем
+    if (settings_.engine != RouterEngine::RAPTOR) {
+        dijkstra_router_ = std::make_unique<graph::DijkstraRouter<RouteWeight>>(graph_);
+    }
+    switch (settings_.engine) {
+        case RouterEngine::RAPTOR:
+            if (!raptor_data_) throw std::logic_error("Raptor data is missing");
+            raptor_router_ = std::make_unique<RaptorRouter>(std::move(*raptor_data_), static_cast<double>(settings_.bus_wait_time),
+                settings_.bus_velocity * (100.0 / 6.0));
+            break;
+        case RouterEngine::DIJKSTRA:
+            if (settings_.search_heuristic == SearchHeuristic::ALT) {
+                if (landmark_data_) landmarks_ = std::make_unique<graph::Landmarks<RouteWeight>>(graph_, std::move(*landmark_data_));
+                else landmarks_ = std::make_unique<graph::Landmarks<RouteWeight>>(graph_, settings_.landmark_count);
+            }
+            else if (settings_.search_heuristic == SearchHeuristic::A_STAR) {
+                const size_t stop_count = geo_bound_data_ ? geo_bound_data_->stop_coordinates.size() : 0;
+                if (!geo_bound_data_ || geo_bound_data_->vertex_stops.size() != graph_.GetVertexCount()
+                    || std::any_of(geo_bound_data_->vertex_stops.begin(), geo_bound_data_->vertex_stops.end(),
+                        [stop_count](uint32_t stop) { return stop >= stop_count; })) {
+                    throw std::logic_error("A* data doesn't match the graph");
+                }
+                for (const auto& coordinates : geo_bound_data_->stop_coordinates) {
+                    stop_points_.push_back(geo::ToUnitVector(coordinates));
+                }
+            }
+            break;
+        case RouterEngine::CONTRACTION_HIERARCHIES:
+            if (hierarchy_data_) contraction_hierarchy_ = std::make_unique<graph::ContractionHierarchy<RouteWeight>>(graph_, std::move(*hierarchy_data_));
+            else contraction_hierarchy_ = std::make_unique<graph::ContractionHierarchy<RouteWeight>>(graph_);
+            break;
+        case RouterEngine::PRECOMPUTED:
+        default:
+            if (routes_table_) router_ = std::make_unique<graph::Router<RouteWeight>>(graph_, std::move(*routes_table_));
+            else if (auto* thread_pool = GetThreadPool()) router_ = std::make_unique<graph::Router<RouteWeight>>(graph_, *thread_pool);
+            else router_ = std::make_unique<graph::Router<RouteWeight>>(graph_);
+            break;
+    }
+    routes_table_.reset();
+    hierarchy_data_.reset();
+    raptor_data_.reset();
+    landmark_data_.reset();
+    // Закэшированные маршруты относятся к прежнему графу
+    route_cache_.reset();
+    if (settings_.route_cache_size > 0) {
+        route_cache_ = std::make_unique<RouteCache>(settings_.route_cache_size);
+    }
+}
+
+cache::CacheStats Router::GetRouteCacheStats() const {
+    return route_cache_ ? route_cache_->GetStats() : cache::CacheStats{};
+}
+
+parallel::ThreadPool* Router::GetThreadPool() {
+    if (settings_.thread_count == 1) return nullptr;
+    if (!thread_pool_) thread_pool_ = std::make_unique<parallel::ThreadPool>(settings_.thread_count);
+    return thread_pool_.get();
+}
+
 } // namespace transport
@@ -1,50 +1,190 @@
 #pragma once
 
 #include "router.h"
+#include "dijkstra_router.h"
+#include "landmarks.h"
+#include "contraction_hierarchy.h"
+#include "raptor_router.h"
 #include "transport_catalogue.h"
+#include "thread_pool.h"
+#include "lru_cache.h"
 
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <string_view>
+#include <unordered_map>
 
 namespace transport {
 
+// Тип весов графа маршрутов задаётся при сборке опцией ROUTE_WEIGHT:
+// double (по умолчанию), float или fixed - целое число тысячных долей минуты
+#if defined(ROUTE_WEIGHT_FLOAT)
+using RouteWeight = float;
+#elif defined(ROUTE_WEIGHT_FIXED)
+using RouteWeight = int32_t;
+#else
+using RouteWeight = double;
+#endif
+
+// Перевод времени в минутах в вес графа и обратно. Вес fixed округляется до ближайшей
+// тысячной доли минуты, то есть ошибается не больше чем на 0.0005 минуты на ребро; время
+// маршрута из k рёбер автобусов отличается от точного не больше чем на 0.0005 * k минуты
+RouteWeight ToRouteWeight(double minutes);
+double ToMinutes(RouteWeight weight);
+
+// Способ поиска маршрутов:
+// PRECOMPUTED - таблица кратчайших путей между всеми парами вершин, строится при загрузке;
+// DIJKSTRA - поиск Дейкстры на каждый запрос, без предрасчёта;
+// CONTRACTION_HIERARCHIES - иерархия сжатия, строится в make_base и сохраняется в базу;
+// RAPTOR - поиск раундами по маршрутам автобусов, рёбра автобусов в граф не добавляются;
+// AUTO - выбор одного из движков на графе по его размеру, memory_budget и expected_queries.
+// Выбранный движок сохраняется в базу вместо AUTO.
+enum class RouterEngine {
+    PRECOMPUTED,
+    DIJKSTRA,
+    CONTRACTION_HIERARCHIES,
+    RAPTOR,
+    AUTO
+};
+
+// Модель графа маршрутов:
+// ALL_PAIRS - ребро для каждой пары остановок каждого автобуса, число рёбер квадратично по длине маршрута;
+// LINEAR - вершины "в автобусе" и рёбра по перегонам, число рёбер линейно по длине маршрута.
+// Ответы на запросы Route в обеих моделях совпадают.
+enum class GraphModel {
+    ALL_PAIRS,
+    LINEAR
+};
+
+// Оценка остатка пути для движка DIJKSTRA:
+// NONE - обычный поиск Дейкстры;
+// A_STAR - A* с оценкой по расстоянию по прямой до цели и наибольшей скорости на перегонах;
+// ALT - A* с оценками по ориентирам, таблицы расстояний до ориентиров строятся в make_base и сохраняются в базу.
+enum class SearchHeuristic {
+    NONE,
+    A_STAR,
+    ALT
+};
+
+// Данные оценки A_STAR: остановка каждой вершины графа, координаты остановок
+// и наименьшее время проезда одного метра по прямой среди всех перегонов
+struct GeoBoundData {
+    double time_per_meter = 0.0;
+    std::vector<uint32_t> vertex_stops;
+    std::vector<geo::Coordinates> stop_coordinates;
+};
+
+struct RoutingSettings {
+    int bus_wait_time = 0;
+    double bus_velocity = 0.0;
+    RouterEngine engine = RouterEngine::AUTO;
+    GraphModel graph_model = GraphModel::ALL_PAIRS;
+    // Число потоков для построения графа и предрасчёта маршрутов, 0 - по числу аппаратных потоков
+    size_t thread_count = 1;
+    // Число последних маршрутов, ответы на которые хранятся в кэше, 0 - кэш выключен
+    size_t route_cache_size = 0;
+    SearchHeuristic search_heuristic = SearchHeuristic::NONE;
+    size_t landmark_count = 8;
+    // Для AUTO: допустимый объём таблицы маршрутов в байтах и ожидаемое число запросов (0 - неизвестно)
+    size_t memory_budget = size_t{ 1 } << 30;
+    size_t expected_queries = 0;
+};
+
 class Router {
 public:
-    //Router() = default;
+    // Вершина входа каждой остановки по её названию; ключи ссылаются на хранилище имён каталога
+    using StopIds = std::unordered_map<std::string_view, graph::VertexId>;
 
-    Router(const int bus_wait_time, const double bus_velocity)
-        : bus_wait_time_(bus_wait_time)
-        , bus_velocity_(bus_velocity) {}
+    explicit Router(const RoutingSettings& settings)
+        : settings_(settings) {}
 
-    Router(const Router& settings, const Catalogue& catalogue) {
-        bus_wait_time_ = settings.bus_wait_time_;
-        bus_velocity_ = settings.bus_velocity_;
+    Router(const RoutingSettings& settings, const Catalogue& catalogue)
+        : settings_(settings) {
         BuildGraph(catalogue);
     }
-    
-    Router(const Router& settings, graph::DirectedWeightedGraph<double> graph, std::map<std::string, graph::VertexId> stop_ids)
-        : bus_wait_time_(settings.bus_wait_time_)
-        , bus_velocity_(settings.bus_velocity_)
-        , graph_(graph)
-        , stop_ids_(stop_ids) {
-           router_ = std::make_unique<graph::Router<double>>(graph_);
+
+    Router(const RoutingSettings& settings, graph::DirectedWeightedGraph<RouteWeight> graph, std::vector<std::string_view> names, size_t stop_count)
+        : settings_(settings)
+        , graph_(std::move(graph))
+        , names_(std::move(names)) {
+           IndexStopIds(stop_count);
+           InitializeRouter();
        }
-    
-    const graph::DirectedWeightedGraph<double>& BuildGraph(const Catalogue& catalogue);
-    const std::optional<graph::Router<double>::RouteInfo> FindRoute(const std::string_view stop_from, const std::string_view stop_to) const;
-    const graph::DirectedWeightedGraph<double>& GetGraph() const;
-    void SetGraph(const graph::DirectedWeightedGraph<double> graph, const std::map<std::string, graph::VertexId> stop_ids);
+
+    const graph::DirectedWeightedGraph<RouteWeight>& BuildGraph(const Catalogue& catalogue);
+    const std::optional<RouteInfo> FindRoute(const std::string_view stop_from, const std::string_view stop_to) const;
+    // Время в пути между всеми парами остановок stops_from x stops_to, nullopt - маршрута нет.
+    // nullopt вместо матрицы, если какой-либо остановки нет в справочнике
+    std::optional<std::vector<std::vector<std::optional<double>>>> FindRouteMatrix(const std::vector<std::string_view>& stops_from,
+        const std::vector<std::string_view>& stops_to) const;
+    // Остановки, до которых можно доехать от stop_from не дольше max_time: пары (номер названия
+    // остановки в таблице имён, время в пути) в порядке возрастания времени; nullopt - остановки нет в справочнике
+    std::optional<std::vector<std::pair<uint32_t, double>>> FindReachableStops(const std::string_view stop_from, double max_time) const;
+    const graph::DirectedWeightedGraph<RouteWeight>& GetGraph() const;
+    // Остановки - первые stop_count имён таблицы, вершина входа i-й остановки - 2 * i
+    void SetGraph(graph::DirectedWeightedGraph<RouteWeight> graph, size_t stop_count);
+    void SetRoutesTable(graph::Router<RouteWeight>::RoutesTable routes_table);
+    const graph::Router<RouteWeight>::RoutesTable* GetRoutesTable() const;
+    void SetHierarchyData(graph::ContractionHierarchy<RouteWeight>::HierarchyData hierarchy_data);
+    const graph::ContractionHierarchy<RouteWeight>::HierarchyData* GetHierarchyData() const;
+    void SetRaptorData(RaptorData raptor_data);
+    const RaptorData* GetRaptorData() const;
+    void SetGeoBoundData(GeoBoundData geo_bound_data);
+    const GeoBoundData* GetGeoBoundData() const;
+    void SetLandmarkData(graph::Landmarks<RouteWeight>::LandmarkData landmark_data);
+    const graph::Landmarks<RouteWeight>::LandmarkData* GetLandmarkData() const;
     const int GetBusWaitTime() const;
     const double GetBusVelocity() const;
-    const Router GetRouterSettings() const;
-    const std::map<std::string, graph::VertexId> GetStopIds() const;
+    const RoutingSettings& GetRoutingSettings() const;
+    cache::CacheStats GetRouteCacheStats() const;
+    // Имена рёбер графа: названия остановок для ожидания и номера автобусов для поездок.
+    // Ссылаются на хранилище имён каталога, который должен жить дольше маршрутизатора
+    std::string_view GetName(uint32_t name_id) const;
+    const std::vector<std::string_view>& GetNames() const;
+    void SetNames(std::vector<std::string_view> names);
+    const StopIds& GetStopIds() const;
 
 private:
-    int bus_wait_time_ = 0;
-    double bus_velocity_ = 0.0;
+    // fill_geo_bound_data строит данные оценки A* из каталога, если их нет в базе
+    void InitializeRouter(const std::function<void()>& fill_geo_bound_data = {});
+    void IndexStopIds(size_t stop_count);
+    RouterEngine SelectEngine() const;
+    uint32_t AddName(std::string_view name);
+    void AddBusEdges(std::vector<graph::Edge<RouteWeight>>& edges, const Catalogue& catalogue, const Bus& bus_info,
+        uint32_t name_id) const;
+    void AddBusRideEdges(std::vector<graph::Edge<RouteWeight>>& edges, const Catalogue& catalogue, const Bus& bus_info,
+        uint32_t name_id, graph::VertexId first_ride_vertex) const;
+    size_t GetRideVertexCount(const Bus& bus_info) const;
+    void FillRaptorData(const Catalogue& catalogue, const std::vector<const Bus*>& buses, const std::vector<uint32_t>& bus_name_ids);
+    RouteInfo MakeRouteInfo(const graph::Router<RouteWeight>::RouteInfo& graph_route) const;
+    static uint32_t GetStopIndex(graph::VertexId vertex);
+    void FillGeoBoundData(const Catalogue& catalogue, const std::vector<const Bus*>& buses,
+        const std::vector<graph::VertexId>& first_ride_vertices, bool is_linear, size_t vertex_count);
+    std::optional<graph::Router<RouteWeight>::RouteInfo> FindDijkstraRoute(graph::VertexId from, graph::VertexId to) const;
+    double ComputeRideTime(int distance) const;
+    parallel::ThreadPool* GetThreadPool();
+
+    RoutingSettings settings_;
 
-    graph::DirectedWeightedGraph<double> graph_;
-    std::map<std::string, graph::VertexId> stop_ids_;
-    std::unique_ptr<graph::Router<double>> router_;
+    graph::DirectedWeightedGraph<RouteWeight> graph_;
+    std::vector<std::string_view> names_;
+    StopIds stop_ids_;
+    std::optional<graph::Router<RouteWeight>::RoutesTable> routes_table_;
+    std::unique_ptr<graph::Router<RouteWeight>> router_;
+    std::unique_ptr<graph::DijkstraRouter<RouteWeight>> dijkstra_router_;
+    std::optional<graph::ContractionHierarchy<RouteWeight>::HierarchyData> hierarchy_data_;
+    std::unique_ptr<graph::ContractionHierarchy<RouteWeight>> contraction_hierarchy_;
+    std::optional<RaptorData> raptor_data_;
+    std::unique_ptr<RaptorRouter> raptor_router_;
+    std::optional<GeoBoundData> geo_bound_data_;
+    std::vector<geo::UnitVector> stop_points_;
+    std::optional<graph::Landmarks<RouteWeight>::LandmarkData> landmark_data_;
+    std::unique_ptr<graph::Landmarks<RouteWeight>> landmarks_;
+    std::unique_ptr<parallel::ThreadPool> thread_pool_;
+    // Ключ - пара вершин (from, to), упакованная в одно число
+    using RouteCache = cache::LruCache<uint64_t, std::optional<RouteInfo>>;
+    std::unique_ptr<RouteCache> route_cache_;
 };
 
 } // namespace transport